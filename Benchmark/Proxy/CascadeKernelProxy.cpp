@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    CascadeKernelProxy.cpp
+
+    A stand-alone stand-in for the cut-filter part of the benchmark, for
+    machines without JUCE. It times JUCE's per-stage IIR pass, with all four
+    stages of a ProcessorChain always running, against the fused cascade
+    kernel CascadeFilter uses, both on one 4-lane SSE register.
+
+    Not part of any project; build and run it with
+
+        g++ -std=c++17 -O2 CascadeKernelProxy.cpp -o CascadeKernelProxy
+        ./CascadeKernelProxy
+
+  ==============================================================================
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <xmmintrin.h>
+
+//==============================================================================
+struct Vector
+{
+    __m128 value;
+};
+
+static inline Vector operator*(Vector a, float b) { return { _mm_mul_ps(a.value, _mm_set1_ps(b)) }; }
+static inline Vector operator+(Vector a, Vector b) { return { _mm_add_ps(a.value, b.value) }; }
+static inline Vector operator-(Vector a, Vector b) { return { _mm_sub_ps(a.value, b.value) }; }
+
+struct Coefficients
+{
+    float b0, b1, b2, a1, a2;
+};
+
+static const Coefficients stages[4] = { { 0.2f, 0.4f, 0.2f, -0.6f,  0.2f  },
+                                        { 0.2f, 0.4f, 0.2f, -0.5f,  0.15f },
+                                        { 0.2f, 0.4f, 0.2f, -0.55f, 0.1f  },
+                                        { 0.2f, 0.4f, 0.2f, -0.62f, 0.21f } };
+
+//==============================================================================
+// The fused kernel: every section per sample in one loop, the state in locals.
+template <int numSections>
+__attribute__((noinline)) void processFused(Vector* data, size_t numSamples, Vector* state)
+{
+    float b0[numSections], b1[numSections], b2[numSections], a1[numSections], a2[numSections];
+    Vector z1[numSections], z2[numSections];
+
+    for (int k = 0; k < numSections; ++k)
+    {
+        b0[k] = stages[k].b0;
+        b1[k] = stages[k].b1;
+        b2[k] = stages[k].b2;
+        a1[k] = stages[k].a1;
+        a2[k] = stages[k].a2;
+        z1[k] = state[2 * k];
+        z2[k] = state[2 * k + 1];
+    }
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        auto x = data[i];
+
+        for (int k = 0; k < numSections; ++k)
+        {
+            const auto y = x * b0[k] + z1[k];
+            z1[k] = x * b1[k] - y * a1[k] + z2[k];
+            z2[k] = x * b2[k] - y * a2[k];
+            x = y;
+        }
+
+        data[i] = x;
+    }
+
+    for (int k = 0; k < numSections; ++k)
+    {
+        state[2 * k] = z1[k];
+        state[2 * k + 1] = z2[k];
+    }
+}
+
+// What IIR::Filter does: one pass over the block per stage.
+__attribute__((noinline)) void processStage(Vector* data, size_t numSamples, Vector* state, const Coefficients& c)
+{
+    auto lv1 = state[0], lv2 = state[1];
+
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        const auto x = data[i];
+        const auto y = x * c.b0 + lv1;
+        lv1 = x * c.b1 - y * c.a1 + lv2;
+        lv2 = x * c.b2 - y * c.a2;
+        data[i] = y;
+    }
+
+    state[0] = lv1;
+    state[1] = lv2;
+}
+
+static void processFused(int numSections, Vector* data, size_t numSamples, Vector* state)
+{
+    switch (numSections)
+    {
+        case 1:  processFused<1>(data, numSamples, state); break;
+        case 2:  processFused<2>(data, numSamples, state); break;
+        case 3:  processFused<3>(data, numSamples, state); break;
+        default: processFused<4>(data, numSamples, state); break;
+    }
+}
+
+//==============================================================================
+int main()
+{
+    using Clock = std::chrono::steady_clock;
+
+    for (const int blockSize : { 32, 256 })
+    {
+        std::vector<Vector> buffer((size_t)blockSize);
+
+        for (auto& sample : buffer)
+            sample.value = _mm_set1_ps(0.1f);
+
+        Vector state[8] = {};
+        const int numIterations = 2000000 * 32 / blockSize;
+        const double numSamples = (double)numIterations * blockSize;
+
+        for (int numSections = 1; numSections <= 4; ++numSections)
+        {
+            const auto start = Clock::now();
+
+            // The chain runs all four stages whatever the slope.
+            for (int i = 0; i < numIterations; ++i)
+                for (int k = 0; k < 4; ++k)
+                    processStage(buffer.data(), (size_t)blockSize, state + 2 * k, stages[k]);
+
+            const auto chainEnd = Clock::now();
+
+            for (int i = 0; i < numIterations; ++i)
+                processFused(numSections, buffer.data(), (size_t)blockSize, state);
+
+            const auto fusedEnd = Clock::now();
+
+            std::printf("block %d slope %d dB: chain %.2f ns/sample, fused %.2f ns/sample\n",
+                        blockSize, numSections * 12,
+                        std::chrono::duration<double, std::nano>(chainEnd - start).count() / numSamples,
+                        std::chrono::duration<double, std::nano>(fusedEnd - chainEnd).count() / numSamples);
+        }
+    }
+
+    return 0;
+}
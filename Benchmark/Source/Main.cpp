@@ -0,0 +1,342 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    SuperFreqBenchmark: times SuperFreqAudioProcessor::processBlock on
+    synthetic buffers across a sweep of configurations and writes the
+    results as JSON.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+// How band2 moves during a run. At block rate the design thread redesigns the
+// chain, so processBlock only picks the result up; the smoothed runs switch the
+// "control rate" parameter to a control grid, where the audio thread redesigns
+// the moving bands itself and the timing includes it.
+enum class Automation
+{
+    none,
+    blockRate,
+    smoothed
+};
+
+static juce::String getName(Automation automation)
+{
+    switch (automation)
+    {
+        case Automation::blockRate: return "block rate";
+        case Automation::smoothed:  return "smoothed";
+        case Automation::none:
+        default:                    return "static";
+    }
+}
+
+struct BenchmarkConfig
+{
+    int blockSize{ 0 };
+    double sampleRate{ 0.0 };
+    int numChannels{ 0 };
+    Slope slope{ Slope::Slope_12 };
+    Automation automation{ Automation::none };
+};
+
+struct BenchmarkSweep
+{
+    juce::Array<int> blockSizes{ 1, 16, 64, 256, 1024, 4096 };
+    juce::Array<double> sampleRates{ 44100.0, 48000.0, 96000.0, 192000.0 };
+    juce::Array<int> channelCounts{ 1, 2, 8 };
+    juce::Array<int> slopes{ Slope::Slope_12, Slope::Slope_24, Slope::Slope_36, Slope::Slope_48 };
+    juce::Array<Automation> automation{ Automation::none, Automation::blockRate, Automation::smoothed };
+
+    // The "control rate" the smoothed runs use.
+    juce::String smoothedControlRate{ "16 samples" };
+
+    // Applied to every configuration before the sweep's own settings, e.g. "processing mode=SVF".
+    juce::StringArray parameterValues;
+
+    // Timed samples per configuration, after a warm-up of a quarter as many, but never
+    // fewer than minTimedBlocks blocks, so that the p99 rests on at least ten of them.
+    int numSamples{ 1 << 16 };
+    static constexpr int minTimedBlocks = 1000;
+};
+
+static void setParameter(SuperFreqAudioProcessor& processor, const juce::String& parameterID, const juce::String& text)
+{
+    if (auto* parameter = processor.apvts.getParameter(parameterID))
+        parameter->setValueNotifyingHost(parameter->getValueForText(text));
+}
+
+static void setParameterValue(SuperFreqAudioProcessor& processor, const juce::String& parameterID, float value)
+{
+    if (auto* parameter = processor.apvts.getParameter(parameterID))
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+// Moves band2 the way a drawn automation curve would: a slow sweep, a little every block.
+static void automate(SuperFreqAudioProcessor& processor, double phase)
+{
+    setParameterValue(processor, "band2 freq", (float)(200.0 * std::pow(20.0, 0.5 + 0.5 * std::sin(phase))));
+    setParameterValue(processor, "band2 gain", (float)(12.0 * std::sin(phase * 1.7)));
+}
+
+//==============================================================================
+/** Per-block processing cost, in nanoseconds per sample frame. */
+struct BenchmarkResult
+{
+    double mean{ 0.0 }, p50{ 0.0 }, p90{ 0.0 }, p99{ 0.0 }, max{ 0.0 };
+    int numBlocks{ 0 };
+
+    // Whether coefficient designs ran inside the timed processBlock calls, i.e. the
+    // "control rate" parameter wasn't at block rate.
+    bool designTimed{ false };
+};
+
+static BenchmarkResult runBenchmark(const BenchmarkConfig& config, const BenchmarkSweep& sweep)
+{
+    SuperFreqAudioProcessor processor;
+
+    // Only the main buses change; the sidechain stays as it is, disabled.
+    auto layout = processor.getBusesLayout();
+    layout.getChannelSet(true, 0) = juce::AudioChannelSet::canonicalChannelSet(config.numChannels);
+    layout.getChannelSet(false, 0) = juce::AudioChannelSet::canonicalChannelSet(config.numChannels);
+    processor.setBusesLayout(layout);
+
+    for (const auto& parameterValue : sweep.parameterValues)
+        setParameter(processor,
+                     parameterValue.upToFirstOccurrenceOf("=", false, false).trim(),
+                     parameterValue.fromFirstOccurrenceOf("=", false, false).trim());
+
+    // Both cuts pulled in from the band edges, so every section does real work.
+    setParameterValue(processor, "band1 slope", (float)config.slope);
+    setParameterValue(processor, "band3 slope", (float)config.slope);
+    setParameterValue(processor, "band1 freq", 80.f);
+    setParameterValue(processor, "band3 freq", 12000.f);
+    setParameterValue(processor, "band2 gain", 6.f);
+
+    if (config.automation == Automation::smoothed)
+        setParameter(processor, "control rate", sweep.smoothedControlRate);
+
+    const auto designTimed = processor.apvts.getRawParameterValue("control rate")->load() > 0.f;
+
+    processor.setRateAndBufferSizeDetails(config.sampleRate, config.blockSize);
+    processor.prepareToPlay(config.sampleRate, config.blockSize);
+
+    // Noise at about -12 dBFS, copied in before every block so the filters never settle into silence.
+    juce::AudioBuffer<float> source(config.numChannels, config.blockSize), buffer(config.numChannels, config.blockSize);
+    juce::Random random(0x5eed);
+
+    for (int channel = 0; channel < config.numChannels; ++channel)
+        for (int i = 0; i < config.blockSize; ++i)
+            source.setSample(channel, i, (random.nextFloat() * 2.f - 1.f) * 0.25f);
+
+    juce::MidiBuffer midi;
+
+    const auto numWarmUpBlocks = juce::jmax(1, sweep.numSamples / 4 / config.blockSize);
+    const auto numBlocks = juce::jmax(BenchmarkSweep::minTimedBlocks, sweep.numSamples / config.blockSize);
+
+    std::vector<double> nanosecondsPerSample;
+    nanosecondsPerSample.reserve((size_t)numBlocks);
+
+    const auto ticksPerSecond = (double)juce::Time::getHighResolutionTicksPerSecond();
+    auto phase = 0.0;
+
+    for (int block = 0; block < numWarmUpBlocks + numBlocks; ++block)
+    {
+        for (int channel = 0; channel < config.numChannels; ++channel)
+            buffer.copyFrom(channel, 0, source, channel, 0, config.blockSize);
+
+        // Setting the parameters is the host's cost and stays out of the timing;
+        // whatever the processor does about the change happens in processBlock.
+        if (config.automation != Automation::none)
+        {
+            automate(processor, phase);
+            phase += juce::MathConstants<double>::twoPi * config.blockSize / config.sampleRate;
+        }
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midi);
+        const auto end = juce::Time::getHighResolutionTicks();
+
+        if (block >= numWarmUpBlocks)
+            nanosecondsPerSample.push_back((double)(end - start) * 1.0e9 / ticksPerSecond / config.blockSize);
+    }
+
+    processor.releaseResources();
+
+    BenchmarkResult result;
+    result.numBlocks = (int)nanosecondsPerSample.size();
+    result.designTimed = designTimed;
+
+    for (auto ns : nanosecondsPerSample)
+        result.mean += ns;
+
+    result.mean /= (double)nanosecondsPerSample.size();
+
+    std::sort(nanosecondsPerSample.begin(), nanosecondsPerSample.end());
+
+    auto percentile = [&](double p) { return nanosecondsPerSample[(size_t)(p * (double)(nanosecondsPerSample.size() - 1))]; };
+
+    result.p50 = percentile(0.5);
+    result.p90 = percentile(0.9);
+    result.p99 = percentile(0.99);
+    result.max = nanosecondsPerSample.back();
+
+    return result;
+}
+
+//==============================================================================
+static juce::var toVar(const BenchmarkConfig& config, const BenchmarkResult& result)
+{
+    auto* object = new juce::DynamicObject();
+
+    object->setProperty("blockSize", config.blockSize);
+    object->setProperty("sampleRate", config.sampleRate);
+    object->setProperty("channels", config.numChannels);
+    object->setProperty("slopeDbPerOct", 12 * (config.slope + 1));
+    object->setProperty("automation", getName(config.automation));
+    object->setProperty("designTimed", result.designTimed);
+    object->setProperty("timedBlocks", result.numBlocks);
+
+    // ns per sample frame, i.e. for all channels of one sample.
+    object->setProperty("nsPerSampleMean", result.mean);
+    object->setProperty("nsPerSampleP50", result.p50);
+    object->setProperty("nsPerSampleP90", result.p90);
+    object->setProperty("nsPerSampleP99", result.p99);
+    object->setProperty("nsPerSampleMax", result.max);
+
+    // The realtime factor of the worst block: below 1 means a dropout at this block size.
+    object->setProperty("worstCaseRealtimeFactor", 1.0e9 / (config.sampleRate * juce::jmax(result.max, 1.0e-9)));
+
+    return object;
+}
+
+static juce::var getSystemInfo(const BenchmarkSweep& sweep)
+{
+    auto* object = new juce::DynamicObject();
+
+    object->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+    object->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    object->setProperty("cpu", juce::SystemStats::getCpuModel());
+    object->setProperty("numCpus", juce::SystemStats::getNumCpus());
+   #if JUCE_DEBUG
+    object->setProperty("debugBuild", true);
+   #else
+    object->setProperty("debugBuild", false);
+   #endif
+    object->setProperty("samplesPerConfig", sweep.numSamples);
+    object->setProperty("minTimedBlocks", BenchmarkSweep::minTimedBlocks);
+    object->setProperty("smoothedControlRate", sweep.smoothedControlRate);
+    object->setProperty("parameters", sweep.parameterValues.joinIntoString(";"));
+
+    return object;
+}
+
+template <typename Type>
+static juce::Array<Type> parseList(const juce::String& text)
+{
+    juce::Array<Type> values;
+
+    for (const auto& token : juce::StringArray::fromTokens(text, ",", ""))
+        values.add((Type)token.getDoubleValue());
+
+    return values;
+}
+
+static void printUsage()
+{
+    std::cout << "Usage: SuperFreqBenchmark [options]\n"
+                 "\n"
+                 "  --output <file>            writes the JSON there rather than to stdout\n"
+                 "  --block-sizes <a,b,...>    default 1,16,64,256,1024,4096\n"
+                 "  --sample-rates <a,b,...>   default 44100,48000,96000,192000\n"
+                 "  --channels <a,b,...>       default 1,2,8\n"
+                 "  --slopes <a,b,...>         dB/Oct of both cuts, default 12,24,36,48\n"
+                 "  --static-only              skips the automated runs\n"
+                 "  --control-rate <choice>    the smoothed runs' \"control rate\", default \"16 samples\"\n"
+                 "  --samples <n>              timed samples per configuration (default 65536),\n"
+                 "                             at least 1000 blocks\n"
+                 "\n"
+                 "Automated runs at block rate leave the coefficient design out of the timing, as\n"
+                 "it happens on the design thread; the smoothed runs design in processBlock.\n"
+                 "  --set \"<id>=<value>\"       sets a parameter for every run, e.g. --set \"processing mode=SVF\"\n";
+}
+
+int main (int argc, char* argv[])
+{
+    // The processor's APVTS needs a message manager, even though no messages are dispatched.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    BenchmarkSweep sweep;
+
+    if (args.containsOption("--block-sizes"))
+        sweep.blockSizes = parseList<int>(args.getValueForOption("--block-sizes"));
+
+    if (args.containsOption("--sample-rates"))
+        sweep.sampleRates = parseList<double>(args.getValueForOption("--sample-rates"));
+
+    if (args.containsOption("--channels"))
+        sweep.channelCounts = parseList<int>(args.getValueForOption("--channels"));
+
+    if (args.containsOption("--slopes"))
+    {
+        sweep.slopes.clear();
+
+        for (auto dbPerOct : parseList<int>(args.getValueForOption("--slopes")))
+            sweep.slopes.add(juce::jlimit((int)Slope::Slope_12, (int)Slope::Slope_48, dbPerOct / 12 - 1));
+    }
+
+    if (args.containsOption("--static-only"))
+        sweep.automation = { Automation::none };
+
+    if (args.containsOption("--control-rate"))
+        sweep.smoothedControlRate = args.getValueForOption("--control-rate");
+
+    if (args.containsOption("--samples"))
+        sweep.numSamples = juce::jmax(1, args.getValueForOption("--samples").getIntValue());
+
+    while (args.containsOption("--set"))
+        sweep.parameterValues.add(args.removeValueForOption("--set"));
+
+    juce::Array<juce::var> results;
+
+    for (auto sampleRate : sweep.sampleRates)
+        for (auto numChannels : sweep.channelCounts)
+            for (auto slope : sweep.slopes)
+                for (auto automation : sweep.automation)
+                    for (auto blockSize : sweep.blockSizes)
+                    {
+                        const BenchmarkConfig config{ juce::jmax(1, blockSize), sampleRate, juce::jmax(1, numChannels), static_cast<Slope>(slope), automation };
+                        const auto result = runBenchmark(config, sweep);
+
+                        std::cerr << (int)sampleRate << " Hz, " << config.numChannels << " ch, " << 12 * (slope + 1) << " dB/Oct, "
+                                  << getName(automation) << (automation != Automation::none && ! result.designTimed ? " (design not timed)" : "")
+                                  << ", block " << config.blockSize << ": " << juce::String(result.mean, 2) << " ns/sample\n";
+
+                        results.add(toVar(config, result));
+                    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("system", getSystemInfo(sweep));
+    root->setProperty("results", results);
+
+    const auto json = juce::JSON::toString(juce::var(root), false);
+
+    if (args.containsOption("--output"))
+        return args.getFileForOption("--output").replaceWithText(json) ? 0 : 1;
+
+    std::cout << json << "\n";
+    return 0;
+}
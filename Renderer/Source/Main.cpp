@@ -0,0 +1,331 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    SuperFreqRenderer: runs SuperFreqAudioProcessor over WAV and FLAC files
+    without a host, one file per worker thread.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/PluginProcessor.h"
+
+//==============================================================================
+struct RenderSettings
+{
+    // A state saved by getStateInformation(), applied before any parameter overrides.
+    juce::MemoryBlock state;
+
+    // "parameter id=value" pairs, where the value is parsed as the parameter's text.
+    juce::StringArray parameterValues;
+
+    juce::File outputDirectory;
+    int blockSize{ 16384 };
+    bool doublePrecision{ false };
+};
+
+struct RenderResult
+{
+    juce::String error;
+    double audioSeconds{ 0.0 }, wallSeconds{ 0.0 };
+};
+
+static juce::String applySettings(SuperFreqAudioProcessor& processor, const RenderSettings& settings)
+{
+    if (settings.state.getSize() > 0)
+        processor.setStateInformation(settings.state.getData(), (int)settings.state.getSize());
+
+    for (const auto& parameterValue : settings.parameterValues)
+    {
+        const auto parameterID = parameterValue.upToFirstOccurrenceOf("=", false, false).trim();
+        const auto text = parameterValue.fromFirstOccurrenceOf("=", false, false).trim();
+
+        auto* parameter = processor.apvts.getParameter(parameterID);
+
+        if (parameter == nullptr)
+            return "unknown parameter \"" + parameterID + "\"";
+
+        parameter->setValueNotifyingHost(parameter->getValueForText(text));
+    }
+
+    return {};
+}
+
+static juce::AudioFormatWriter* createWriter(juce::AudioFormat& format, const juce::File& file, const juce::AudioFormatReader& reader)
+{
+    // Keeps the source's bit depth where the format allows it, otherwise its deepest one.
+    auto bitsPerSample = (int)reader.bitsPerSample;
+    const auto possibleBitDepths = format.getPossibleBitDepths();
+
+    if (! possibleBitDepths.contains(bitsPerSample))
+        bitsPerSample = possibleBitDepths.getLast();
+
+    file.deleteFile();
+    auto stream = file.createOutputStream();
+
+    if (stream == nullptr)
+        return nullptr;
+
+    auto* writer = format.createWriterFor(stream.get(), reader.sampleRate, reader.numChannels, bitsPerSample, reader.metadataValues, 0);
+
+    // On success the writer owns the stream.
+    if (writer != nullptr)
+        stream.release();
+
+    return writer;
+}
+
+static RenderResult renderFile(const juce::File& input, const RenderSettings& settings)
+{
+    RenderResult result;
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    // Readers stream from disk, so only one chunk of the file is ever in memory.
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+
+    if (reader == nullptr)
+        return { "can't open as audio" };
+
+    auto* format = formatManager.findFormatForFileExtension(input.getFileExtension());
+    const auto output = settings.outputDirectory.getChildFile(input.getFileName());
+
+    if (format == nullptr)
+        return { "no writer for this format" };
+
+    if (output == input)
+        return { "the output would overwrite the input" };
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(createWriter(*format, output, *reader));
+
+    if (writer == nullptr)
+        return { "can't write " + output.getFullPathName() };
+
+    const auto numChannels = (int)reader->numChannels;
+    const auto blockSize = settings.blockSize;
+
+    SuperFreqAudioProcessor processor;
+
+    // Only the main buses change; the sidechain stays as it is, disabled.
+    auto layout = processor.getBusesLayout();
+    layout.getChannelSet(true, 0) = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+    layout.getChannelSet(false, 0) = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+
+    if (! processor.setBusesLayout(layout))
+        return { "unsupported channel count" };
+
+    if (auto error = applySettings(processor, settings); error.isNotEmpty())
+        return { error };
+
+    processor.setProcessingPrecision(settings.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                              : juce::AudioProcessor::singlePrecision);
+    processor.setNonRealtime(true);
+    processor.setRateAndBufferSizeDetails(reader->sampleRate, blockSize);
+    processor.prepareToPlay(reader->sampleRate, blockSize);
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::AudioBuffer<double> doubleBuffer(settings.doublePrecision ? numChannels : 0, settings.doublePrecision ? blockSize : 0);
+    juce::MidiBuffer midi;
+
+    // The output is shifted back by the reported latency, and the input padded with
+    // silence at the end to flush it, so the rendered file lines up with the source.
+    const auto latency = (juce::int64)processor.getLatencySamples();
+    const auto length = reader->lengthInSamples;
+
+    juce::int64 position = 0, written = 0;
+
+    while (written < length)
+    {
+        buffer.clear();
+
+        const auto numToRead = (int)juce::jlimit((juce::int64)0, (juce::int64)blockSize, length - position);
+
+        if (numToRead > 0)
+            reader->read(&buffer, 0, numToRead, position, true, true);
+
+        if (settings.doublePrecision)
+        {
+            doubleBuffer.makeCopyOf(buffer, true);
+            processor.processBlock(doubleBuffer, midi);
+            buffer.makeCopyOf(doubleBuffer, true);
+        }
+        else
+        {
+            processor.processBlock(buffer, midi);
+        }
+
+        const auto skip = (int)juce::jlimit((juce::int64)0, (juce::int64)blockSize, latency - position);
+        const auto numToWrite = (int)juce::jmin((juce::int64)(blockSize - skip), length - written);
+
+        if (numToWrite > 0 && ! writer->writeFromAudioSampleBuffer(buffer, skip, numToWrite))
+            return { "write failed" };
+
+        written += juce::jmax(0, numToWrite);
+        position += blockSize;
+    }
+
+    processor.releaseResources();
+
+    result.audioSeconds = (double)length / reader->sampleRate;
+    result.wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+    return result;
+}
+
+//==============================================================================
+static void addInputFiles(juce::Array<juce::File>& files, const juce::File& file)
+{
+    if (file.isDirectory())
+        files.addArray(file.findChildFiles(juce::File::findFiles, false, "*.wav;*.flac"));
+    else
+        files.add(file);
+}
+
+static juce::String getRealtimeFactor(double audioSeconds, double wallSeconds)
+{
+    return juce::String(audioSeconds / juce::jmax(wallSeconds, 1.0e-9), 1) + "x realtime";
+}
+
+static void printUsage()
+{
+    std::cout << "Usage: SuperFreqRenderer [options] <file or directory>...\n"
+                 "\n"
+                 "  --output <dir>          where rendered files go (required)\n"
+                 "  --state <file>          a saved plug-in state to render with\n"
+                 "  --set \"<id>=<value>\"    overrides one parameter, e.g. --set \"band2 gain=3\"\n"
+                 "  --save-state <file>     writes the state after --set and exits\n"
+                 "  --block-size <samples>  samples per processBlock call (default 16384)\n"
+                 "  --threads <n>           worker threads (default: one per core)\n"
+                 "  --double                processes in double precision\n";
+}
+
+int main (int argc, char* argv[])
+{
+    // The processor's APVTS needs a message manager, even though no messages are dispatched.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args(argc, argv);
+
+    if (args.size() == 0 || args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    RenderSettings settings;
+
+    if (args.containsOption("--state"))
+    {
+        const auto stateFile = args.getFileForOption("--state");
+
+        if (! stateFile.loadFileAsData(settings.state))
+        {
+            std::cerr << "Can't read " << stateFile.getFullPathName() << "\n";
+            return 1;
+        }
+
+        args.removeValueForOption("--state");
+    }
+
+    while (args.containsOption("--set"))
+        settings.parameterValues.add(args.removeValueForOption("--set"));
+
+    if (args.containsOption("--save-state"))
+    {
+        const auto stateFile = args.getFileForOption("--save-state");
+
+        SuperFreqAudioProcessor processor;
+
+        if (auto error = applySettings(processor, settings); error.isNotEmpty())
+        {
+            std::cerr << error << "\n";
+            return 1;
+        }
+
+        juce::MemoryBlock state;
+        processor.getStateInformation(state);
+
+        return stateFile.replaceWithData(state.getData(), state.getSize()) ? 0 : 1;
+    }
+
+    if (args.containsOption("--block-size"))
+        settings.blockSize = juce::jmax(1, args.removeValueForOption("--block-size").getIntValue());
+
+    auto numThreads = juce::SystemStats::getNumCpus();
+
+    if (args.containsOption("--threads"))
+        numThreads = juce::jmax(1, args.removeValueForOption("--threads").getIntValue());
+
+    settings.doublePrecision = args.removeOptionIfFound("--double");
+
+    if (! args.containsOption("--output"))
+    {
+        printUsage();
+        return 1;
+    }
+
+    settings.outputDirectory = args.getFileForOption("--output");
+    args.removeValueForOption("--output");
+
+    if (! settings.outputDirectory.createDirectory())
+    {
+        std::cerr << "Can't create " << settings.outputDirectory.getFullPathName() << "\n";
+        return 1;
+    }
+
+    juce::Array<juce::File> files;
+
+    for (const auto& arg : args.arguments)
+        addInputFiles(files, arg.resolveAsFile());
+
+    // Each job writes only its own slot, so the results need no locking.
+    std::vector<RenderResult> results((size_t)files.size());
+    juce::CriticalSection printLock;
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    {
+        juce::ThreadPool pool(juce::jmin(numThreads, juce::jmax(1, files.size())));
+
+        for (int i = 0; i < files.size(); ++i)
+        {
+            pool.addJob([&, i]
+            {
+                const auto& file = files.getReference(i);
+                auto& result = results[(size_t)i];
+
+                result = renderFile(file, settings);
+
+                const juce::ScopedLock sl(printLock);
+
+                if (result.error.isNotEmpty())
+                    std::cerr << file.getFileName() << ": " << result.error << "\n";
+                else
+                    std::cout << file.getFileName() << ": " << getRealtimeFactor(result.audioSeconds, result.wallSeconds) << "\n";
+            });
+        }
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep(50);
+    }
+
+    const auto wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    auto audioSeconds = 0.0;
+    auto numFailed = 0;
+
+    for (const auto& result : results)
+    {
+        audioSeconds += result.audioSeconds;
+        numFailed += result.error.isNotEmpty() ? 1 : 0;
+    }
+
+    std::cout << "Rendered " << (files.size() - numFailed) << " of " << files.size() << " files, "
+              << juce::String(audioSeconds, 1) << " s of audio in " << juce::String(wallSeconds, 1) << " s: "
+              << getRealtimeFactor(audioSeconds, wallSeconds) << " on " << numThreads << " threads\n";
+
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    BinaryState.cpp
+
+  ==============================================================================
+*/
+
+#include "BinaryState.h"
+
+//==============================================================================
+BinaryState::BinaryState(const juce::Array<juce::AudioProcessorParameter*>& parameters)
+{
+    for (auto* parameter : parameters)
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+            entries.push_back({ hashParameterID(ranged->paramID), ranged });
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+
+    // Two IDs with the same hash couldn't be told apart in a saved state; rename one.
+    jassert(std::adjacent_find(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.hash == b.hash; }) == entries.end());
+}
+
+juce::uint32 BinaryState::hashParameterID(const juce::String& parameterID) noexcept
+{
+    auto hash = (juce::uint32)2166136261u;
+
+    for (auto* c = parameterID.toRawUTF8(); *c != 0; ++c)
+        hash = (hash ^ (juce::uint8)*c) * 16777619u;
+
+    return hash;
+}
+
+static void writeLittleEndian(char* destination, juce::uint32 value) noexcept
+{
+    value = juce::ByteOrder::swapIfBigEndian(value);
+    std::memcpy(destination, &value, sizeof(value));
+}
+
+void BinaryState::write(juce::MemoryBlock& destData) const
+{
+    destData.setSize((size_t)(headerSize + entrySize * (int)entries.size()));
+    auto* destination = static_cast<char*>(destData.getData());
+
+    writeLittleEndian(destination, magic);
+    writeLittleEndian(destination + 4, (juce::uint32)currentVersion | ((juce::uint32)entries.size() << 16));
+    destination += headerSize;
+
+    for (const auto& entry : entries)
+    {
+        const auto value = entry.parameter->convertFrom0to1(entry.parameter->getValue());
+
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        writeLittleEndian(destination, entry.hash);
+        writeLittleEndian(destination + 4, bits);
+        destination += entrySize;
+    }
+}
+
+bool BinaryState::canRead(const void* data, int sizeInBytes) noexcept
+{
+    if (data == nullptr || sizeInBytes < headerSize || juce::ByteOrder::littleEndianInt(data) != magic)
+        return false;
+
+    const auto* bytes = static_cast<const char*>(data);
+    const auto version = juce::ByteOrder::littleEndianShort(bytes + 4);
+    const auto numEntries = (int)juce::ByteOrder::littleEndianShort(bytes + 6);
+
+    return version >= 1 && version <= currentVersion && sizeInBytes >= headerSize + numEntries * entrySize;
+}
+
+bool BinaryState::read(const void* data, int sizeInBytes) const
+{
+    if (! canRead(data, sizeInBytes))
+        return false;
+
+    const auto* record = static_cast<const char*>(data) + headerSize;
+    const auto numRecords = (int)juce::ByteOrder::littleEndianShort(static_cast<const char*>(data) + 6);
+    auto recordIndex = 0;
+
+    // Both lists are sorted by hash, so one pass pairs them up.
+    for (const auto& entry : entries)
+    {
+        auto value = entry.parameter->convertFrom0to1(entry.parameter->getDefaultValue());
+
+        while (recordIndex < numRecords && juce::ByteOrder::littleEndianInt(record + recordIndex * entrySize) < entry.hash)
+            ++recordIndex;
+
+        if (recordIndex < numRecords && juce::ByteOrder::littleEndianInt(record + recordIndex * entrySize) == entry.hash)
+        {
+            const auto bits = juce::ByteOrder::littleEndianInt(record + recordIndex * entrySize + 4);
+            float recorded;
+            std::memcpy(&recorded, &bits, sizeof(recorded));
+
+            if (std::isfinite(recorded))
+                value = recorded;
+        }
+
+        // Hosts are only told about parameters that actually move.
+        const auto normalised = entry.parameter->convertTo0to1(value);
+
+        if (normalised != entry.parameter->getValue())
+            entry.parameter->setValueNotifyingHost(normalised);
+    }
+
+    return true;
+}
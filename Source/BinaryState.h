@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    BinaryState.h
+
+    The plugin state as a compact, versioned binary record of parameter values.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Saves and restores every ranged parameter as a flat little-endian record:
+
+        uint32 magic, uint16 version, uint16 numEntries,
+        numEntries * { uint32 ID hash, float32 plain value }
+
+    with the entries in ascending order of hash. A parameter is identified by
+    the FNV-1a hash of its ID, so parameters can be added, removed or reordered
+    between versions: ones the record doesn't mention go back to their defaults
+    and entries nobody owns any more are skipped. A state of a few dozen
+    parameters is a few hundred bytes, and reading it is one merge of two
+    sorted lists, without allocating.
+*/
+class BinaryState
+{
+public:
+    static constexpr juce::uint32 magic = 0x51464653; // "SFFQ"
+    static constexpr juce::uint16 currentVersion = 1;
+
+    /** Indexes the ranged parameters of the list by ID hash. */
+    explicit BinaryState(const juce::Array<juce::AudioProcessorParameter*>& parameters);
+
+    /** Replaces the block's contents with the current values. */
+    void write(juce::MemoryBlock& destData) const;
+
+    /** Whether the data starts like a record this build can read. */
+    static bool canRead(const void* data, int sizeInBytes) noexcept;
+
+    /** Sets every parameter from the record, notifying the host of those that
+        change. Returns false, and changes nothing, if the data can't be read.
+    */
+    bool read(const void* data, int sizeInBytes) const;
+
+    static juce::uint32 hashParameterID(const juce::String& parameterID) noexcept;
+
+private:
+    static constexpr int headerSize = 8, entrySize = 8;
+
+    struct Entry
+    {
+        juce::uint32 hash;
+        juce::RangedAudioParameter* parameter;
+    };
+
+    // Sorted by hash.
+    std::vector<Entry> entries;
+
+    JUCE_DECLARE_NON_COPYABLE(BinaryState)
+};
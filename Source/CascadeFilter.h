@@ -0,0 +1,217 @@
+/*
+  ==============================================================================
+
+    CascadeFilter.h
+
+    A runtime list of second-order sections, evaluated a few sections at a
+    time for every sample, rather than one full pass over the block per section.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** Second-order section coefficients, normalised so that a0 == 1. */
+template <typename NumericType>
+struct BiquadCoefficients
+{
+    NumericType b0{ 1 }, b1{ 0 }, b2{ 0 };
+    NumericType a1{ 0 }, a2{ 0 };
+
+    /** The same section at another precision. */
+    template <typename OtherType>
+    static BiquadCoefficients from(const BiquadCoefficients<OtherType>& c) noexcept
+    {
+        return { (NumericType)c.b0, (NumericType)c.b1, (NumericType)c.b2, (NumericType)c.a1, (NumericType)c.a2 };
+    }
+};
+
+/** A biquad in transposed direct form II. */
+template <typename NumericType>
+struct BiquadSection
+{
+    using Coefficients = BiquadCoefficients<NumericType>;
+
+    template <typename SampleType>
+    struct State
+    {
+        SampleType s1 = SampleType(0), s2 = SampleType(0);
+    };
+
+    template <typename SampleType>
+    static SampleType process(SampleType x, const Coefficients& c, State<SampleType>& z) noexcept
+    {
+        const auto y = (x * c.b0) + z.s1;
+        z.s1 = (x * c.b1) - (y * c.a1) + z.s2;
+        z.s2 = (x * c.b2) - (y * c.a2);
+        return y;
+    }
+};
+
+//==============================================================================
+/**
+    Runs a list of up to maxSections second-order sections that is set up at
+    run time, on any number of chains that share the coefficients.
+
+    The store is a structure of arrays: the coefficients of the active sections,
+    packed in processing order, a slot index per active section, and one state
+    array per chain indexed by slot. Inactive sections are not in the list, so
+    they cost nothing per sample, and a section keeps its state however the list
+    around it changes. Slots that drop out are cleared, so whatever they belong to
+    starts from silence if it comes back.
+
+    The list is processed in passes of up to sectionsPerPass sections. Each pass
+    is a fully unrolled kernel, instantiated for every section count up to
+    sectionsPerPass, with the state of its sections held in registers for the
+    whole block. setSections() picks the kernel of every pass from a table, so
+    process() just calls them in turn: whatever the bands and slopes, the
+    sample loops hold no bypass checks or branches, and sectionsPerPass kernels
+    per sample type cover every combination.
+
+    Section supplies the topology: its Coefficients, its per-section State and a
+    static process() for one sample. A BiquadSection of SampleType's precision
+    is the default. SampleType may be a juce::dsp::SIMDRegister, so that each
+    chain filters several channels at once.
+*/
+template <typename SampleType, int maxSections,
+          typename Section = BiquadSection<typename juce::dsp::SampleTypeHelpers::ElementType<SampleType>::Type>>
+class SectionCascade
+{
+public:
+    using Coefficients = typename Section::Coefficients;
+
+    static constexpr int sectionsPerPass = 4;
+
+    /** Sizes the state store for numChains chains. Allocates. */
+    void prepare(size_t numChains)
+    {
+        state.assign(numChains * (size_t)maxSections, State());
+    }
+
+    void reset() noexcept
+    {
+        std::fill(state.begin(), state.end(), State());
+    }
+
+    /** Takes over a new list of numSections sections, designed at any precision,
+        and the state slot each of them owns. Allocation-free.
+    */
+    template <typename OtherCoefficients>
+    void setSections(const OtherCoefficients* sections, const juce::uint8* sectionSlots, int numSections) noexcept
+    {
+        jassert(numSections <= maxSections);
+
+        SlotMask newMask = 0;
+
+        for (int i = 0; i < numSections; ++i)
+        {
+            coefficients[(size_t)i] = Coefficients::from(sections[i]);
+            slots[(size_t)i] = sectionSlots[i];
+            newMask |= SlotMask(1) << sectionSlots[i];
+        }
+
+        numActive = numSections;
+        numPasses = (numActive + sectionsPerPass - 1) / sectionsPerPass;
+
+        for (int pass = 0; pass < numPasses; ++pass)
+            passKernels[(size_t)pass] = getKernel(juce::jmin(sectionsPerPass, numActive - pass * sectionsPerPass),
+                                                  std::make_integer_sequence<int, sectionsPerPass>());
+
+        if (const auto droppedOut = activeMask & ~newMask)
+            for (size_t chainState = 0; chainState < state.size(); chainState += (size_t)maxSections)
+                for (int slot = 0; slot < maxSections; ++slot)
+                    if ((droppedOut >> slot) & 1)
+                        state[chainState + (size_t)slot] = State();
+
+        activeMask = newMask;
+    }
+
+    /** Replaces the coefficients of those of the given sections that are in the
+        list already, such as one band's, leaving the rest alone.
+    */
+    template <typename OtherCoefficients>
+    void updateSections(const OtherCoefficients* sections, const juce::uint8* sectionSlots, int numSections) noexcept
+    {
+        for (int i = 0; i < numSections; ++i)
+            for (int position = 0; position < numActive; ++position)
+                if (slots[(size_t)position] == sectionSlots[i])
+                    coefficients[(size_t)position] = Coefficients::from(sections[i]);
+    }
+
+    int getNumActiveSections() const noexcept { return numActive; }
+
+    /** Filters one chain's samples in place. */
+    void process(size_t chain, SampleType* samples, size_t numSamples) noexcept
+    {
+        jassert((chain + 1) * (size_t)maxSections <= state.size());
+
+        auto* chainState = state.data() + chain * (size_t)maxSections;
+
+        for (int pass = 0; pass < numPasses; ++pass)
+            (this->*passKernels[(size_t)pass])(samples, numSamples, pass * sectionsPerPass, chainState);
+    }
+
+private:
+    using State = typename Section::template State<SampleType>;
+    using SlotMask = std::uint64_t;
+
+    static_assert(maxSections <= 64, "Slots are tracked in a 64-bit mask");
+
+    static constexpr int maxPasses = (maxSections + sectionsPerPass - 1) / sectionsPerPass;
+
+    // Filters a pass of sections, starting at the given position in the list.
+    using Kernel = void (SectionCascade::*)(SampleType*, size_t, int, State*) noexcept;
+
+    // The kernel instantiated for a pass of count sections, 1 to sectionsPerPass.
+    template <int... index>
+    static Kernel getKernel(int count, std::integer_sequence<int, index...>) noexcept
+    {
+        static constexpr Kernel kernels[] = { &SectionCascade::processStages<index + 1>... };
+
+        return kernels[count - 1];
+    }
+
+    // Expanded at compile time rather than left to the optimiser's loop unrolling,
+    // which otherwise tends to keep the section state in memory.
+    template <int... stage>
+    static SampleType processSample(SampleType x, const Coefficients* c, State* z,
+                                    std::integer_sequence<int, stage...>) noexcept
+    {
+        ((x = Section::process(x, c[stage], z[stage])), ...);
+        return x;
+    }
+
+    template <int numStages>
+    void processStages(SampleType* samples, size_t numSamples, int first, State* chainState) noexcept
+    {
+        Coefficients c[numStages];
+        State z[numStages];
+
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            c[stage] = coefficients[(size_t)(first + stage)];
+            z[stage] = chainState[slots[(size_t)(first + stage)]];
+        }
+
+        for (size_t i = 0; i < numSamples; ++i)
+            samples[i] = processSample(samples[i], c, z, std::make_integer_sequence<int, numStages>());
+
+        for (int stage = 0; stage < numStages; ++stage)
+            chainState[slots[(size_t)(first + stage)]] = z[stage];
+    }
+
+    std::array<Coefficients, maxSections> coefficients;
+    std::array<juce::uint8, maxSections> slots{};
+    int numActive{ 0 };
+
+    // The kernel of each pass over the list, as setSections() left it.
+    std::array<Kernel, maxPasses> passKernels{};
+    int numPasses{ 0 };
+    SlotMask activeMask{ 0 };
+
+    // maxSections states per chain, indexed by slot.
+    std::vector<State> state;
+};
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.cpp
+
+  ==============================================================================
+*/
+
+#include "ChannelWorkerPool.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+//==============================================================================
+class ChannelWorkerPool::Worker  : public juce::Thread
+{
+public:
+    explicit Worker(ChannelWorkerPool& owner) : juce::Thread("SuperFreq Channel Worker"), pool(owner) {}
+
+    ~Worker() override
+    {
+        stop();
+    }
+
+    // Only signals a worker that has gone to sleep; a spinning one sees the new generation itself.
+    void wake() noexcept
+    {
+        if (sleeping.exchange(false))
+            wakeUp.signal();
+    }
+
+    void stop()
+    {
+        signalThreadShouldExit();
+        wakeUp.signal();
+        stopThread(1000);
+    }
+
+    void run() override
+    {
+        const juce::ScopedNoDenormals noDenormals;
+        auto seenGeneration = pool.generation.load(std::memory_order_acquire);
+
+        auto hasJob = [&] { return pool.generation.load(std::memory_order_acquire) != seenGeneration; };
+
+        while (! threadShouldExit())
+        {
+            if (! spinUntil(hasJob))
+            {
+                // Checked again once the sleep is announced, so a job posted in between isn't slept through.
+                sleeping.store(true);
+
+                if (! hasJob() && ! threadShouldExit())
+                    wakeUp.wait();
+
+                sleeping.store(false);
+                continue;
+            }
+
+            seenGeneration = pool.generation.load(std::memory_order_acquire);
+
+            const RealtimeInstrumentation::ScopedHelper scopedHelper(pool.instrumentation.load(std::memory_order_relaxed));
+            pool.runTasks();
+        }
+    }
+
+private:
+    ChannelWorkerPool& pool;
+    std::atomic<bool> sleeping{ false };
+    juce::WaitableEvent wakeUp;
+};
+
+//==============================================================================
+ChannelWorkerPool::ChannelWorkerPool() = default;
+
+ChannelWorkerPool::~ChannelWorkerPool()
+{
+    stopWorkers();
+}
+
+void ChannelWorkerPool::setNumWorkers(int numWorkers)
+{
+    numWorkers = juce::jlimit(0, maxWorkers, numWorkers);
+
+    if (numWorkers == (int)workers.size())
+        return;
+
+    // Keeps new jobs off the workers, then waits out one that got in first.
+    workersAvailable.store(false);
+
+    while (jobRunning.load())
+        juce::Thread::yield();
+
+    stopWorkers();
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>(*this));
+        workers.back()->startThread(juce::Thread::Priority::highest);
+    }
+
+    workersAvailable.store(numWorkers > 0);
+}
+
+bool ChannelWorkerPool::beginJob() noexcept
+{
+    jobRunning.store(true);
+
+    if (workersAvailable.load())
+        return true;
+
+    jobRunning.store(false);
+    return false;
+}
+
+void ChannelWorkerPool::stopWorkers()
+{
+    for (auto& worker : workers)
+        worker->stop();
+
+    workers.clear();
+}
+
+template <typename Condition>
+bool ChannelWorkerPool::spinUntil(Condition&& condition) noexcept
+{
+    for (int i = 0; i < spinIterations; ++i)
+    {
+        if (condition())
+            return true;
+
+       #if JUCE_INTEL
+        _mm_pause();
+       #endif
+    }
+
+    return condition();
+}
+
+void ChannelWorkerPool::run(int numTasks) noexcept
+{
+    jassert(numTasks <= 0xffff);
+
+    // The job is complete before anything is published, so the workers see all of it.
+    instrumentation.store(RealtimeInstrumentation::getCurrent(), std::memory_order_relaxed);
+    unfinishedTasks.store(numTasks);
+    nextTask.store((juce::uint32)numTasks << 16, std::memory_order_release);
+    generation.fetch_add(1, std::memory_order_release);
+
+    for (auto& worker : workers)
+        worker->wake();
+
+    runTasks();
+
+    if (! spinUntil([this] { return unfinishedTasks.load(std::memory_order_acquire) == 0; }))
+    {
+        callerWaiting.store(true);
+
+        while (unfinishedTasks.load(std::memory_order_acquire) != 0)
+            jobDone.wait();
+
+        callerWaiting.store(false);
+    }
+}
+
+void ChannelWorkerPool::runTasks() noexcept
+{
+    for (;;)
+    {
+        const auto claim = nextTask.fetch_add(1, std::memory_order_acq_rel);
+        const auto task = (int)(claim & 0xffff);
+
+        if (task >= (int)(claim >> 16))
+            return;
+
+        runTask(context, task);
+
+        if (unfinishedTasks.fetch_sub(1) == 1 && callerWaiting.load())
+            jobDone.signal();
+    }
+}
@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.h
+
+    A few pre-spawned threads that help the audio thread through the channel
+    groups of very wide busses.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "RealtimeInstrumentation.h"
+
+//==============================================================================
+/**
+    Runs the tasks of a parallelFor() on the calling thread and on up to
+    maxWorkers worker threads at once.
+
+    Tasks are claimed one at a time from a shared atomic counter, so a thread
+    that finishes early takes over work the others haven't started, without
+    any per-thread queues. Between jobs the workers spin for a while before
+    going to sleep, and the caller likewise spins before waiting for the last
+    task, so back-to-back blocks hand over without a system call. Waking a
+    sleeping worker does take one, which the audio thread's instrumentation
+    counts as a mutex lock. While running tasks, a worker counts into the same
+    instrumentation as the thread that started the job.
+
+    The workers are started and stopped by setNumWorkers() on another thread,
+    without the audio thread ever waiting for it: while the pool is being
+    resized, parallelFor() just runs every task itself. parallelFor() isn't
+    reentrant: one audio thread owns the pool.
+*/
+class ChannelWorkerPool
+{
+public:
+    static constexpr int maxWorkers = 3;
+
+    ChannelWorkerPool();
+    ~ChannelWorkerPool();
+
+    /** Stops any running workers and starts numWorkers new ones, up to maxWorkers,
+        unless that many are running already; 0 stops them all. Allocates, and waits
+        for a job the audio thread may be running, so call it from the message
+        thread or the design thread.
+    */
+    void setNumWorkers(int numWorkers);
+
+    /** Calls function(task) for every task in [0, numTasks), returning once all of
+        them have finished. The tasks must be independent of each other.
+    */
+    template <typename Function>
+    void parallelFor(int numTasks, Function& function) noexcept
+    {
+        if (numTasks < 2 || ! beginJob())
+        {
+            for (int task = 0; task < numTasks; ++task)
+                function(task);
+
+            return;
+        }
+
+        context = &function;
+        runTask = [](void* functionPointer, int task) { (*static_cast<Function*>(functionPointer))(task); };
+
+        run(numTasks);
+        endJob();
+    }
+
+private:
+    class Worker;
+
+    // Claims the workers for a job, unless setNumWorkers() has them or there are none.
+    bool beginJob() noexcept;
+    void endJob() noexcept { jobRunning.store(false); }
+
+    void run(int numTasks) noexcept;
+    void stopWorkers();
+
+    // Claims and runs tasks of the current job until there are none left.
+    void runTasks() noexcept;
+
+    // Busy-waits for up to spinIterations checks of the condition, returning whether it came true.
+    template <typename Condition>
+    static bool spinUntil(Condition&& condition) noexcept;
+
+    static constexpr int spinIterations = 4000;
+
+    // The current job, published to the workers by bumping generation.
+    void* context = nullptr;
+    void (*runTask)(void*, int) = nullptr;
+    std::atomic<RealtimeInstrumentation*> instrumentation{ nullptr };
+
+    // The job's task count in the high 16 bits and the next unclaimed task in the
+    // low ones, so a claim made with a late fetch_add is always for the job that
+    // is current: either a real task of it, whose context is already published,
+    // or past its end.
+    std::atomic<juce::uint32> nextTask{ 0 };
+    std::atomic<int> unfinishedTasks{ 0 };
+    std::atomic<juce::uint32> generation{ 0 };
+
+    // Set by the caller before it sleeps, so whoever finishes the last task wakes it.
+    std::atomic<bool> callerWaiting{ false };
+    juce::WaitableEvent jobDone;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // A handshake between parallelFor() and setNumWorkers(), both sequentially
+    // consistent, so that at most one of them goes ahead with the workers.
+    std::atomic<bool> workersAvailable{ false }, jobRunning{ false };
+
+    JUCE_DECLARE_NON_COPYABLE(ChannelWorkerPool)
+};
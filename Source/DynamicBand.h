@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    DynamicBand.h
+
+    The detector and gain computer that turn band2 into a dynamic bell.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CascadeFilter.h"
+#include "FastCoefficientMath.h"
+
+//==============================================================================
+/**
+    Follows the level of a detector signal in band2's band and turns it into a
+    gain offset for the bell, like a compressor acting on that band only.
+
+    The detector downmixes its input, band-passes it with a unity-peak section
+    at band2's frequency and Q, and runs a peak envelope follower on the result,
+    every sample but on a single mono channel. The gain is only worked out at
+    control ticks, so the per-sample cost is one biquad and a one-pole filter.
+*/
+class DynamicBand
+{
+public:
+    /** The rate the detector signal arrives at. */
+    void prepare(double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+
+        // Forces the band and the timing to be worked out for the new rate.
+        bandFrequency = 0.f;
+        attackMs = releaseMs = 0.f;
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        state = {};
+        envelope = 0.f;
+    }
+
+    /** Follows band2 and the timing parameters. Only redesigns what has changed,
+        so this is cheap enough to call at every control tick.
+    */
+    void setParameters(float frequency, float q, float newAttackMs, float newReleaseMs) noexcept
+    {
+        frequency = juce::jmin(frequency, (float)(sampleRate * 0.49));
+
+        if (frequency != bandFrequency || q != bandQ)
+        {
+            bandFrequency = frequency;
+            bandQ = q;
+
+            // A bell-only prototype at 0 dB is a band-pass with unity gain at its centre.
+            const FastCoefficientMath::Section section{ frequency, q, 0.f, 0.f, 1.f, 0.f };
+            FastCoefficientMath::designSections(&section, &bandPass, 1, sampleRate);
+        }
+
+        if (newAttackMs != attackMs || newReleaseMs != releaseMs)
+        {
+            attackMs = newAttackMs;
+            releaseMs = newReleaseMs;
+
+            attack = getOnePoleCoefficient(attackMs);
+            release = getOnePoleCoefficient(releaseMs);
+        }
+    }
+
+    /** Runs the detector over the next samples of its input. */
+    template <typename SampleType>
+    void analyse(const juce::dsp::AudioBlock<const SampleType>& detector) noexcept
+    {
+        const auto numChannels = detector.getNumChannels();
+
+        if (numChannels == 0)
+            return;
+
+        const auto channelGain = 1.f / (float)numChannels;
+
+        for (size_t i = 0; i < detector.getNumSamples(); ++i)
+        {
+            auto x = 0.f;
+
+            for (size_t channel = 0; channel < numChannels; ++channel)
+                x += (float)detector.getSample((int)channel, (int)i);
+
+            const auto level = std::abs(BiquadSection<float>::process(x * channelGain, bandPass, state));
+            envelope += (level > envelope ? attack : release) * (level - envelope);
+        }
+
+        // Keeps the follower out of the denormal range during silence.
+        if (envelope < 1.0e-9f)
+            envelope = 0.f;
+    }
+
+    /** The bell's gain offset for the current envelope: the band's level above
+        threshold comes down by 1 - 1 / ratio of the overshoot, up to maxReductionDecibels.
+    */
+    float getGainDecibels(float thresholdDecibels, float ratio) const noexcept
+    {
+        const auto overshoot = juce::Decibels::gainToDecibels(envelope, -100.f) - thresholdDecibels;
+
+        return overshoot > 0.f ? juce::jmax(-maxReductionDecibels, -overshoot * (1.f - 1.f / ratio)) : 0.f;
+    }
+
+    static constexpr float maxReductionDecibels = 24.f;
+
+private:
+    float getOnePoleCoefficient(float milliseconds) const noexcept
+    {
+        return 1.f - std::exp(-1.f / (juce::jmax(0.01f, milliseconds) * 0.001f * (float)sampleRate));
+    }
+
+    double sampleRate{ 44100.0 };
+
+    float bandFrequency{ 0.f }, bandQ{ 0.f };
+    BiquadCoefficients<float> bandPass;
+    BiquadSection<float>::State<float> state;
+
+    float attackMs{ 0.f }, releaseMs{ 0.f };
+    float attack{ 1.f }, release{ 1.f };
+    float envelope{ 0.f };
+};
@@ -0,0 +1,241 @@
+/*
+  ==============================================================================
+
+    FastCoefficientMath.h
+
+    Biquad and SVF design without libm: tan and exp2 are replaced by
+    polynomial approximations, and several sections are designed at once,
+    one per SIMD lane.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CascadeFilter.h"
+#include "SvfSection.h"
+
+namespace FastCoefficientMath
+{
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+
+    //==============================================================================
+    /** sin(x) for 0 <= x <= pi / 2, Taylor series to x^11 (absolute error below 6e-8). */
+    inline SIMDFloat sin(SIMDFloat x) noexcept
+    {
+        const auto x2 = x * x;
+
+        auto p = SIMDFloat::expand(-1.f / 39916800.f);
+        p = SIMDFloat::expand( 1.f / 362880.f) + p * x2;
+        p = SIMDFloat::expand(-1.f / 5040.f) + p * x2;
+        p = SIMDFloat::expand( 1.f / 120.f) + p * x2;
+        p = SIMDFloat::expand(-1.f / 6.f) + p * x2;
+        p = SIMDFloat::expand( 1.f) + p * x2;
+
+        return p * x;
+    }
+
+    /** 1 / x for x > 0. SSE's estimate is good to 12 bits and NEON's to 8, so one
+        and two Newton steps take it to within 2e-7. SIMDRegister has no division, so
+        anywhere else it divides lane by lane.
+    */
+    inline SIMDFloat reciprocal(SIMDFloat x) noexcept
+    {
+       #if JUCE_USE_SSE_INTRINSICS
+        const auto estimate = SIMDFloat::fromNative(_mm_rcp_ps(x.value));
+        return estimate * (SIMDFloat::expand(2.f) - x * estimate);
+       #elif JUCE_USE_ARM_NEON
+        auto estimate = vrecpeq_f32(x.value);
+        estimate = vmulq_f32(estimate, vrecpsq_f32(x.value, estimate));
+        return SIMDFloat::fromNative(vmulq_f32(estimate, vrecpsq_f32(x.value, estimate)));
+       #else
+        auto result = x;
+
+        for (size_t i = 0; i < SIMDFloat::size(); ++i)
+            result.set(i, 1.f / x.get(i));
+
+        return result;
+       #endif
+    }
+
+    /** tan(x) for 0 <= x < pi / 2 as sin(x) / sin(pi / 2 - x), so the small
+        denominator near pi / 2 keeps its relative accuracy. Relative error stays
+        below 2e-6 up to 0.49 of the sample rate.
+    */
+    inline SIMDFloat tan(SIMDFloat x) noexcept
+    {
+        return sin(x) * reciprocal(sin(SIMDFloat::expand(juce::MathConstants<float>::halfPi) - x));
+    }
+
+    /** 2^x for |x| <= 8: a degree 6 polynomial for 2^(x / 16), squared four times.
+        Relative error stays below 2e-6.
+    */
+    inline SIMDFloat exp2(SIMDFloat x) noexcept
+    {
+        constexpr auto ln2 = 0.693147180559945f;
+
+        const auto y = SIMDFloat::min(SIMDFloat::max(x, SIMDFloat::expand(-8.f)), SIMDFloat::expand(8.f)) * (ln2 / 16.f);
+
+        auto p = SIMDFloat::expand(1.f / 720.f);
+        p = SIMDFloat::expand(1.f / 120.f) + p * y;
+        p = SIMDFloat::expand(1.f / 24.f) + p * y;
+        p = SIMDFloat::expand(1.f / 6.f) + p * y;
+        p = SIMDFloat::expand(1.f / 2.f) + p * y;
+        p = SIMDFloat::expand(1.f) + p * y;
+        p = SIMDFloat::expand(1.f) + p * y;
+
+        p = p * p;
+        p = p * p;
+        p = p * p;
+        return p * p;
+    }
+
+    //==============================================================================
+    /**
+        One second-order section to design.
+
+        The analog prototype is H(s) = (highPass s^2 + bell (A / Q) s + lowPass)
+                                      / (s^2 + s / (A Q) + 1)
+        with A = 10^(gainDecibels / 40), so { 1, 0, 0 } is a high-pass, { 0, 0, 1 }
+        a low-pass and { 1, 1, 1 } a peak. Keep gainDecibels at 0 for the cuts.
+
+        Setting lowShelf or highShelf to 1 instead, with the other three at 0,
+        designs that RBJ shelf.
+    */
+    struct Section
+    {
+        float frequency{ 1000.f }, q{ 0.7071f }, gainDecibels{ 0.f };
+        float highPass{ 0.f }, bell{ 0.f }, lowPass{ 0.f };
+        float lowShelf{ 0.f }, highShelf{ 0.f };
+    };
+
+    /** The parameters of up to SIMDFloat::size() sections, one per lane. */
+    struct SectionLanes
+    {
+        SIMDFloat x, invQ, exponent;
+        SIMDFloat highPass, bell, lowPass;
+        SIMDFloat lowShelf, highShelf;
+    };
+
+    /** Loads numLanes sections, with x = pi fc / fs and exponent = log2(A). */
+    inline SectionLanes loadSections(const Section* sections, int numLanes, double sampleRate) noexcept
+    {
+        const auto piOverSampleRate = static_cast<float>(juce::MathConstants<double>::pi / sampleRate);
+        const auto decibelsToExponent = 0.0830482024f; // log2(10) / 40
+
+        // Unused lanes design a harmless pass-through at a quarter of the sample rate.
+        SectionLanes lanes{ SIMDFloat::expand(juce::MathConstants<float>::pi * 0.25f), SIMDFloat::expand(1.f), SIMDFloat::expand(0.f),
+                            SIMDFloat::expand(0.f), SIMDFloat::expand(0.f), SIMDFloat::expand(0.f),
+                            SIMDFloat::expand(0.f), SIMDFloat::expand(0.f) };
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            const auto& section = sections[lane];
+
+            lanes.x.set((size_t)lane, section.frequency * piOverSampleRate);
+            lanes.invQ.set((size_t)lane, 1.f / section.q);
+            lanes.exponent.set((size_t)lane, section.gainDecibels * decibelsToExponent);
+            lanes.highPass.set((size_t)lane, section.highPass);
+            lanes.bell.set((size_t)lane, section.bell);
+            lanes.lowPass.set((size_t)lane, section.lowPass);
+            lanes.lowShelf.set((size_t)lane, section.lowShelf);
+            lanes.highShelf.set((size_t)lane, section.highShelf);
+        }
+
+        return lanes;
+    }
+
+    /** Bilinear-transforms numSections prototypes, SIMDFloat::size() at a time.
+        Matches juce::dsp::IIR::ArrayCoefficients' high-pass, low-pass, peak and
+        shelf designs to within the accuracy of tan() and exp2() above. The design
+        is in float whatever the precision of the result.
+    */
+    template <typename NumericType>
+    void designSections(const Section* sections, BiquadCoefficients<NumericType>* result, int numSections, double sampleRate) noexcept
+    {
+        constexpr auto lanes = (int)SIMDFloat::size();
+
+        for (int first = 0; first < numSections; first += lanes)
+        {
+            const auto numLanes = juce::jmin(lanes, numSections - first);
+            const auto p = loadSections(sections + first, numLanes, sampleRate);
+
+            const auto k = tan(p.x);
+            const auto k2 = k * k;
+            const auto numeratorK = k * p.invQ * exp2(p.exponent);
+            const auto denominatorK = k * p.invQ * exp2(SIMDFloat::expand(0.f) - p.exponent);
+
+            const auto one = SIMDFloat::expand(1.f);
+            const auto highPassPlusLowPassK2 = p.highPass + p.lowPass * k2;
+
+            // The shelves are RBJ's, with cos w and sin w written in terms of k and
+            // everything scaled by (1 + k^2) / 2, which normalisation takes out again.
+            const auto a = exp2(p.exponent);
+            const auto h = k * p.invQ * exp2(p.exponent * 0.5f);
+            const auto aK2 = a * k2;
+            const auto cuts = one - p.lowShelf - p.highShelf;
+
+            const auto b0 = highPassPlusLowPassK2 + p.bell * numeratorK
+                          + p.lowShelf * a * (one + aK2 + h) + p.highShelf * a * (a + k2 + h);
+            const auto b1 = (p.lowPass * k2 - p.highPass) * 2.f
+                          + p.lowShelf * a * (aK2 - one) * 2.f + p.highShelf * a * (k2 - a) * 2.f;
+            const auto b2 = highPassPlusLowPassK2 - p.bell * numeratorK
+                          + p.lowShelf * a * (one + aK2 - h) + p.highShelf * a * (a + k2 - h);
+            const auto a0 = cuts * (one + denominatorK + k2) + p.lowShelf * (a + k2 + h) + p.highShelf * (one + aK2 + h);
+            const auto a1 = cuts * (k2 - one) * 2.f + p.lowShelf * (k2 - a) * 2.f + p.highShelf * (aK2 - one) * 2.f;
+            const auto a2 = cuts * (one - denominatorK + k2) + p.lowShelf * (a + k2 - h) + p.highShelf * (one + aK2 - h);
+
+            const auto a0Inv = reciprocal(a0);
+            const auto nb0 = b0 * a0Inv, nb1 = b1 * a0Inv, nb2 = b2 * a0Inv, na1 = a1 * a0Inv, na2 = a2 * a0Inv;
+
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                const auto i = (size_t)lane;
+
+                result[first + lane] = BiquadCoefficients<NumericType>::from(BiquadCoefficients<float>{ nb0.get(i), nb1.get(i), nb2.get(i), na1.get(i), na2.get(i) });
+            }
+        }
+    }
+
+    /** The same prototypes as state-variable sections. With k = 1 / (A Q) the
+        response is highPass HP + bell A^2 k BP + lowPass LP of the SVF outputs,
+        so only g and the shared a1..a3 need the division. The shelves use
+        k = 1 / Q and move g by sqrt(A), as SvfCoefficients' shelves do.
+    */
+    template <typename NumericType>
+    void designSvfSections(const Section* sections, SvfCoefficients<NumericType>* result, int numSections, double sampleRate) noexcept
+    {
+        constexpr auto lanes = (int)SIMDFloat::size();
+
+        for (int first = 0; first < numSections; first += lanes)
+        {
+            const auto numLanes = juce::jmin(lanes, numSections - first);
+            const auto p = loadSections(sections + first, numLanes, sampleRate);
+
+            const auto one = SIMDFloat::expand(1.f);
+            const auto cuts = one - p.lowShelf - p.highShelf;
+
+            const auto g = tan(p.x) * exp2(p.exponent * 0.5f * (p.highShelf - p.lowShelf));
+            const auto a = exp2(p.exponent);
+            const auto aSquared = a * a;
+            const auto k = p.invQ * exp2(SIMDFloat::expand(0.f) - p.exponent * cuts);
+
+            const auto denominator = one + g * (g + k);
+            const auto m0 = p.highPass + p.lowShelf + p.highShelf * aSquared;
+            const auto m1 = k * (p.bell * aSquared - p.highPass + p.lowShelf * (a - one) + p.highShelf * (one - a) * a);
+            const auto m2 = p.lowPass - p.highPass + (p.lowShelf - p.highShelf) * (aSquared - one);
+
+            const auto a1 = reciprocal(denominator);
+            const auto a2 = g * a1;
+            const auto a3 = g * a2;
+
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                const auto i = (size_t)lane;
+
+                result[first + lane] = SvfCoefficients<NumericType>::from(SvfCoefficients<float>{ a1.get(i), a2.get(i), a3.get(i), m0.get(i), m1.get(i), m2.get(i) });
+            }
+        }
+    }
+}
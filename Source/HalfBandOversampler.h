@@ -0,0 +1,227 @@
+/*
+  ==============================================================================
+
+    HalfBandOversampler.h
+
+    2x / 4x oversampling with polyphase half-band IIR stages that run on
+    SIMDRegister samples, so one instance resamples a whole channel group.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    The allpass coefficients of each half-band stage, designed once by
+    juce::dsp::FilterDesign and shared by every oversampler.
+
+    Each half-band filter is 0.5 (A0(z^2) + z^-1 A1(z^2)), where A0 and A1 are
+    cascades of first-order allpasses in z^2, so the filter runs at the lower
+    of its two rates, one polyphase branch per output (or input) phase.
+*/
+struct HalfBandStages
+{
+    static constexpr int maxStages = 2;
+
+    struct Stage
+    {
+        std::vector<float> direct, delayed;
+
+        // At DC, in samples of the stage's higher rate, through one filter.
+        double latency{ 0.0 };
+    };
+
+    std::array<Stage, maxStages> stages;
+
+    static const HalfBandStages& get()
+    {
+        static const HalfBandStages halfBandStages;
+        return halfBandStages;
+    }
+
+    /** The delay of an up-then-down pass through numStages stages, in samples of the base rate. */
+    static double getLatencyInSamples(int numStages)
+    {
+        auto latency = 0.0;
+
+        for (int i = 0; i < numStages; ++i)
+            latency += 2.0 * get().stages[(size_t)i].latency / (double)(2 << i);
+
+        return latency;
+    }
+
+private:
+    HalfBandStages()
+    {
+        // The first stage keeps everything below 0.4 fs; later ones only have to
+        // reject the images of a signal that is already band limited, so they
+        // can use a much wider transition band and fewer allpasses.
+        design(stages[0], 0.1f, -75.f);
+        design(stages[1], 0.25f, -70.f);
+    }
+
+    static void design(Stage& stage, float normalisedTransitionWidth, float stopbandAmplitudedB)
+    {
+        const auto structure = juce::dsp::FilterDesign<float>::designIIRLowpassHalfBandPolyphaseAllpassMethod(normalisedTransitionWidth,
+                                                                                                               stopbandAmplitudedB);
+
+        // The coefficients alternate between the two branches.
+        for (int i = 0; i < structure.alpha.size(); ++i)
+            (i % 2 == 0 ? stage.direct : stage.delayed).push_back((float)structure.alpha[i]);
+
+        // A first-order allpass (a + z^-1) / (1 + a z^-1) delays DC by (1 - a) / (1 + a).
+        auto directDelay = 0.0, delayedDelay = 1.0;
+
+        for (auto a : stage.direct)
+            directDelay += 2.0 * (1.0 - a) / (1.0 + a);
+
+        for (auto a : stage.delayed)
+            delayedDelay += 2.0 * (1.0 - a) / (1.0 + a);
+
+        stage.latency = 0.5 * (directDelay + delayedDelay);
+    }
+};
+
+//==============================================================================
+/**
+    Up- and downsamples one channel of SampleType by 2^numStages, where
+    SampleType may be a juce::dsp::SIMDRegister holding several channels.
+
+    Like juce::dsp::Oversampling, processSamplesUp() returns a block at the
+    higher rate to process in place, and processSamplesDown() brings it back.
+    Everything is allocated in prepare().
+*/
+template <typename SampleType>
+class HalfBandOversampler
+{
+public:
+    void prepare(size_t maximumBlockSize)
+    {
+        const auto& halfBandStages = HalfBandStages::get();
+
+        for (int i = 0; i < HalfBandStages::maxStages; ++i)
+        {
+            auto& stage = stages[(size_t)i];
+            const auto& coefficients = halfBandStages.stages[(size_t)i];
+
+            stage.direct = coefficients.direct.data();
+            stage.delayed = coefficients.delayed.data();
+            stage.numDirect = (int)coefficients.direct.size();
+            stage.numDelayed = (int)coefficients.delayed.size();
+
+            stage.upState.assign(coefficients.direct.size() + coefficients.delayed.size(), SampleType(0));
+            stage.downState.assign(coefficients.direct.size() + coefficients.delayed.size(), SampleType(0));
+
+            stage.buffer.assign(maximumBlockSize << (i + 1), SampleType(0));
+        }
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& stage : stages)
+        {
+            std::fill(stage.upState.begin(), stage.upState.end(), SampleType(0));
+            std::fill(stage.downState.begin(), stage.downState.end(), SampleType(0));
+            stage.previousDelayed = SampleType(0);
+        }
+    }
+
+    /** 1 for 2x, 2 for 4x. */
+    void setNumStages(int newNumStages) noexcept
+    {
+        jassert(newNumStages > 0 && newNumStages <= HalfBandStages::maxStages);
+        numStages = newNumStages;
+    }
+
+    juce::dsp::AudioBlock<SampleType> processSamplesUp(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        auto* input = block.getChannelPointer(0);
+        auto numSamples = block.getNumSamples();
+
+        for (int i = 0; i < numStages; ++i)
+        {
+            auto& stage = stages[(size_t)i];
+            jassert((numSamples << 1) <= stage.buffer.size());
+
+            stage.up(input, stage.buffer.data(), numSamples);
+
+            input = stage.buffer.data();
+            numSamples <<= 1;
+        }
+
+        upsampled = stages[(size_t)(numStages - 1)].buffer.data();
+        return { &upsampled, 1, numSamples };
+    }
+
+    void processSamplesDown(juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        const auto numSamples = block.getNumSamples();
+
+        for (int i = numStages - 1; i >= 0; --i)
+        {
+            auto* output = i > 0 ? stages[(size_t)(i - 1)].buffer.data() : block.getChannelPointer(0);
+            stages[(size_t)i].down(stages[(size_t)i].buffer.data(), output, numSamples << i);
+        }
+    }
+
+private:
+    static SampleType processAllpasses(SampleType x, const float* coefficients, SampleType* state, int numAllpasses) noexcept
+    {
+        for (int k = 0; k < numAllpasses; ++k)
+        {
+            const auto y = x * coefficients[k] + state[k];
+            state[k] = x - y * coefficients[k];
+            x = y;
+        }
+
+        return x;
+    }
+
+    struct Stage
+    {
+        // Each input sample gives one output sample per branch.
+        void up(const SampleType* input, SampleType* output, size_t numSamples) noexcept
+        {
+            auto* directState = upState.data();
+            auto* delayedState = directState + numDirect;
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                output[i << 1]       = processAllpasses(input[i], direct, directState, numDirect);
+                output[(i << 1) + 1] = processAllpasses(input[i], delayed, delayedState, numDelayed);
+            }
+        }
+
+        // The odd phase meets the z^-1 of the delayed branch, so it pairs with the next even sample.
+        void down(const SampleType* input, SampleType* output, size_t numSamples) noexcept
+        {
+            auto* directState = downState.data();
+            auto* delayedState = directState + numDirect;
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                const auto even = processAllpasses(input[i << 1], direct, directState, numDirect);
+                output[i] = (even + previousDelayed) * 0.5f;
+                previousDelayed = processAllpasses(input[(i << 1) + 1], delayed, delayedState, numDelayed);
+            }
+        }
+
+        const float* direct = nullptr;
+        const float* delayed = nullptr;
+        int numDirect{ 0 }, numDelayed{ 0 };
+
+        std::vector<SampleType> upState, downState, buffer;
+        SampleType previousDelayed = SampleType(0);
+    };
+
+    std::array<Stage, HalfBandStages::maxStages> stages;
+    int numStages{ 1 };
+
+    // The block returned by processSamplesUp() refers to this channel pointer.
+    SampleType* upsampled = nullptr;
+};
@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+    LinearPhaseFilter.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseFilter.h"
+#include "RealtimeInstrumentation.h"
+
+//==============================================================================
+int LinearPhaseFilter::getFirOrder(double sampleRate) noexcept
+{
+    const auto length = juce::nextPowerOfTwo(juce::roundToInt(sampleRate * 0.085));
+
+    return juce::jlimit(partitionOrder + 2, maxFirOrder, juce::roundToInt(std::log2((double)length)));
+}
+
+int LinearPhaseFilter::getLatencyInSamples(double sampleRate) noexcept
+{
+    return (1 << getFirOrder(sampleRate)) / 2 + partitionSize;
+}
+
+static double getMagnitude(const BiquadCoefficients<double>& c, double omega)
+{
+    const auto z1 = std::polar(1.0, -omega);
+    const auto z2 = z1 * z1;
+
+    return std::abs((c.b0 + c.b1 * z1 + c.b2 * z2) / (1.0 + c.a1 * z1 + c.a2 * z2));
+}
+
+void LinearPhaseFilter::designKernel(Kernel& kernel, const BiquadCoefficients<double>* sections, int numSections, double sampleRate)
+{
+    RealtimeInstrumentation::noteDesign();
+
+    const auto firOrder = getFirOrder(sampleRate);
+    const auto firLength = 1 << firOrder;
+
+    // A real, zero-phase spectrum: its inverse is the impulse centred on sample 0.
+    juce::dsp::FFT firFft(firOrder);
+    std::vector<float> impulse((size_t)(2 * firLength), 0.f);
+
+    for (int bin = 0; bin <= firLength / 2; ++bin)
+    {
+        const auto omega = juce::MathConstants<double>::twoPi * bin / firLength;
+        auto magnitude = 1.0;
+
+        for (int i = 0; i < numSections; ++i)
+            magnitude *= getMagnitude(sections[i], omega);
+
+        impulse[(size_t)(2 * bin)] = (float)magnitude;
+    }
+
+    firFft.performRealOnlyInverseTransform(impulse.data());
+
+    // Rotated to the middle of the FIR and Hann windowed, which keeps it symmetric.
+    std::vector<float> fir((size_t)firLength);
+
+    for (int n = 0; n < firLength; ++n)
+    {
+        const auto window = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * n / firLength);
+        fir[(size_t)n] = (float)(impulse[(size_t)((n + firLength / 2) % firLength)] * window);
+    }
+
+    // Each partition is zero-padded to the FFT size, as overlap-save needs.
+    juce::dsp::FFT partitionFft(partitionOrder + 1);
+    std::vector<float> partition((size_t)(2 * fftSize));
+
+    kernel.numPartitions = firLength / partitionSize;
+    kernel.spectra.resize((size_t)(kernel.numPartitions * spectrumSize));
+
+    for (int p = 0; p < kernel.numPartitions; ++p)
+    {
+        std::fill(partition.begin(), partition.end(), 0.f);
+        std::copy_n(fir.begin() + p * partitionSize, partitionSize, partition.begin());
+
+        partitionFft.performRealOnlyForwardTransform(partition.data(), true);
+        std::copy_n(partition.begin(), spectrumSize, kernel.spectra.begin() + p * spectrumSize);
+    }
+
+    kernel.sampleRate = sampleRate;
+}
+
+//==============================================================================
+void LinearPhaseFilter::prepare(int newNumChannels, double sampleRate)
+{
+    preparedSampleRate = sampleRate;
+    numChannels = newNumChannels;
+    numPartitions = (1 << getFirOrder(sampleRate)) / partitionSize;
+
+    inputs.assign((size_t)(numChannels * fftSize), 0.f);
+    outputs.assign((size_t)(numChannels * partitionSize), 0.f);
+    delayLine.assign((size_t)(numChannels * numPartitions * spectrumSize), 0.f);
+    scratch.assign((size_t)(2 * fftSize), 0.f);
+    crossfade.assign((size_t)partitionSize, 0.f);
+
+    reset();
+}
+
+void LinearPhaseFilter::reset() noexcept
+{
+    std::fill(inputs.begin(), inputs.end(), 0.f);
+    std::fill(outputs.begin(), outputs.end(), 0.f);
+    std::fill(delayLine.begin(), delayLine.end(), 0.f);
+
+    fifoIndex = 0;
+    delayLineIndex = 0;
+}
+
+template <typename SampleType>
+void LinearPhaseFilter::process(juce::dsp::AudioBlock<SampleType> block, TripleBuffer<Kernel>& kernels) noexcept
+{
+    const auto numChannelsToProcess = juce::jmin((int)block.getNumChannels(), numChannels);
+    const auto numSamples = block.getNumSamples();
+
+    for (size_t start = 0; start < numSamples;)
+    {
+        const auto length = juce::jmin((size_t)(partitionSize - fifoIndex), numSamples - start);
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+        {
+            auto* samples = block.getChannelPointer((size_t)channel) + start;
+
+            std::copy_n(samples, length, getInput(channel) + partitionSize + fifoIndex);
+            std::copy_n(getOutput(channel) + fifoIndex, length, samples);
+        }
+
+        fifoIndex += (int)length;
+        start += length;
+
+        if (fifoIndex == partitionSize)
+        {
+            processPartition(kernels);
+            fifoIndex = 0;
+        }
+    }
+}
+
+template void LinearPhaseFilter::process<float>(juce::dsp::AudioBlock<float>, TripleBuffer<Kernel>&) noexcept;
+template void LinearPhaseFilter::process<double>(juce::dsp::AudioBlock<double>, TripleBuffer<Kernel>&) noexcept;
+
+void LinearPhaseFilter::processPartition(TripleBuffer<Kernel>& kernels) noexcept
+{
+    delayLineIndex = (delayLineIndex + 1) % numPartitions;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* input = getInput(channel);
+
+        std::copy_n(input, fftSize, scratch.begin());
+        std::fill(scratch.begin() + fftSize, scratch.end(), 0.f);
+
+        fft.performRealOnlyForwardTransform(scratch.data(), true);
+        std::copy_n(scratch.begin(), spectrumSize, getSpectrum(channel, delayLineIndex));
+
+        // Overlap-save: the newest partition becomes the older half of the next window.
+        std::copy_n(input + partitionSize, partitionSize, input);
+    }
+
+    // The old kernel's output is taken before acquire() hands its slot back to the design thread.
+    for (int channel = 0; channel < numChannels; ++channel)
+        convolve(kernels.getReadBuffer(), channel, getOutput(channel));
+
+    if (! kernels.acquire())
+        return;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        convolve(kernels.getReadBuffer(), channel, crossfade.data());
+
+        auto* output = getOutput(channel);
+
+        for (int i = 0; i < partitionSize; ++i)
+            output[i] += (crossfade[(size_t)i] - output[i]) * (float)(i + 1) / (float)partitionSize;
+    }
+}
+
+void LinearPhaseFilter::convolve(const Kernel& kernel, int channel, float* destination) noexcept
+{
+    if (kernel.numPartitions != numPartitions || kernel.sampleRate != preparedSampleRate)
+    {
+        juce::FloatVectorOperations::clear(destination, partitionSize);
+        return;
+    }
+
+    auto* accumulator = scratch.data();
+    std::fill(scratch.begin(), scratch.end(), 0.f);
+
+    // Partition p of the FIR meets the input block from p partitions ago.
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        const auto* x = getSpectrum(channel, (delayLineIndex - p + numPartitions) % numPartitions);
+        const auto* h = kernel.spectra.data() + (size_t)(p * spectrumSize);
+
+        for (int i = 0; i < spectrumSize; i += 2)
+        {
+            accumulator[i]     += x[i] * h[i]     - x[i + 1] * h[i + 1];
+            accumulator[i + 1] += x[i] * h[i + 1] + x[i + 1] * h[i];
+        }
+    }
+
+    fft.performRealOnlyInverseTransform(accumulator);
+
+    // The first half is circularly aliased; the second is the valid linear convolution.
+    juce::FloatVectorOperations::copy(destination, accumulator + partitionSize, partitionSize);
+}
@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    LinearPhaseFilter.h
+
+    A linear-phase FIR with the magnitude response of a biquad cascade,
+    applied by uniformly partitioned overlap-save FFT convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CascadeFilter.h"
+#include "TripleBuffer.h"
+
+//==============================================================================
+/**
+    Convolves every channel with the same linear-phase FIR.
+
+    The FIR is split into partitions of partitionSize taps whose spectra are
+    multiplied with a frequency-domain delay line of past input blocks, so the
+    cost per sample grows with the FIR length over partitionSize rather than
+    with the FIR length itself.
+
+    New kernels arrive through a TripleBuffer and are swapped in at a partition
+    boundary, crossfading from the old kernel's output to the new one's over
+    that partition. Both see the same delay line, so the crossfade is seamless.
+*/
+class LinearPhaseFilter
+{
+public:
+    static constexpr int partitionOrder = 8;
+    static constexpr int partitionSize = 1 << partitionOrder;
+
+private:
+    static constexpr int fftSize = 2 * partitionSize;
+
+    // A real FFT of fftSize samples gives fftSize / 2 + 1 complex bins.
+    static constexpr int spectrumSize = fftSize + 2;
+
+    static constexpr int maxFirOrder = 14;
+
+public:
+    //==============================================================================
+    /** log2 of the FIR length: about 85 ms of impulse response, so that the low
+        cuts stay steep at any sample rate.
+    */
+    static int getFirOrder(double sampleRate) noexcept;
+
+    /** Half the FIR plus one partition of input buffering. */
+    static int getLatencyInSamples(double sampleRate) noexcept;
+
+    //==============================================================================
+    /** The partition spectra of one FIR, sized by designKernel() for the FIR length
+        of the sample rate it is designed for.
+    */
+    struct Kernel
+    {
+        double sampleRate{ 0.0 };
+        int numPartitions{ 0 };
+        std::vector<float> spectra;
+    };
+
+    /** Designs a linear-phase FIR with the magnitude response of the given sections
+        and a delay of half its length. Allocates, so call it off the audio thread.
+    */
+    static void designKernel(Kernel& kernel, const BiquadCoefficients<double>* sections, int numSections, double sampleRate);
+
+    //==============================================================================
+    /** Sizes the delay line for the FIR length at this sample rate. Allocates. */
+    void prepare(int numChannels, double sampleRate);
+
+    int getNumChannels() const noexcept { return numChannels; }
+    double getSampleRate() const noexcept { return preparedSampleRate; }
+
+    /** Clears the delay line. Allocation-free. */
+    void reset() noexcept;
+
+    /** Filters the block in place, picking up the latest kernel at each partition boundary.
+        The convolution itself is in float whatever the block's precision.
+    */
+    template <typename SampleType>
+    void process(juce::dsp::AudioBlock<SampleType> block, TripleBuffer<Kernel>& kernels) noexcept;
+
+private:
+    void processPartition(TripleBuffer<Kernel>& kernels) noexcept;
+
+    // Writes one partition of output for the channel, or silence if the kernel
+    // was designed for another sample rate.
+    void convolve(const Kernel& kernel, int channel, float* destination) noexcept;
+
+    float* getInput(int channel) noexcept { return inputs.data() + (size_t)(channel * fftSize); }
+    float* getOutput(int channel) noexcept { return outputs.data() + (size_t)(channel * partitionSize); }
+    float* getSpectrum(int channel, int partition) noexcept { return delayLine.data() + (size_t)((channel * numPartitions + partition) * spectrumSize); }
+
+    juce::dsp::FFT fft{ partitionOrder + 1 };
+
+    double preparedSampleRate{ 0.0 };
+    int numChannels{ 0 }, numPartitions{ 0 };
+
+    // Per channel: the last two input partitions, the pending output partition
+    // and the spectra of the last numPartitions input blocks.
+    std::vector<float> inputs, outputs, delayLine;
+    std::vector<float> scratch, crossfade;
+
+    int fifoIndex{ 0 }, delayLineIndex{ 0 };
+};
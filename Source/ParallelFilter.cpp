@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    ParallelFilter.cpp
+
+  ==============================================================================
+*/
+
+#include "ParallelFilter.h"
+#include "RealtimeInstrumentation.h"
+
+//==============================================================================
+using Complex = std::complex<double>;
+
+// The roots of z^2 + a1 z + a2, the poles of a section. Real pairs use the form
+// that doesn't lose the smaller root to cancellation.
+static std::pair<Complex, Complex> getPoles(double a1, double a2)
+{
+    const auto discriminant = a1 * a1 - 4.0 * a2;
+
+    if (discriminant < 0.0)
+    {
+        const auto imaginary = 0.5 * std::sqrt(-discriminant);
+        return { { -0.5 * a1, imaginary }, { -0.5 * a1, -imaginary } };
+    }
+
+    const auto q = -0.5 * (a1 + std::copysign(std::sqrt(discriminant), a1));
+
+    if (q == 0.0)
+        return { 0.0, 0.0 };
+
+    return { q, a2 / q };
+}
+
+// A section's response at z, written in positive powers of z so it stays finite at z = 0.
+static Complex getResponse(const BiquadCoefficients<double>& c, Complex z)
+{
+    return ((c.b0 * z + c.b1) * z + c.b2) / ((z + c.a1) * z + c.a2);
+}
+
+// The worst deviation of the expansion from the cascade, with its coefficients
+// rounded through CoefficientType, over log-spaced frequencies up to 0.49 fs.
+template <typename CoefficientType>
+static double measureError(const ParallelForm& form, const BiquadCoefficients<double>* sections, int numSections, double sampleRate)
+{
+    constexpr int numPoints = 256;
+
+    auto round = [](double x) { return (double)static_cast<CoefficientType>(x); };
+
+    const auto minFrequency = juce::jmin(10.0, sampleRate * 0.01);
+    auto worst = 0.0;
+
+    for (int point = 0; point < numPoints; ++point)
+    {
+        const auto frequency = minFrequency * std::pow(sampleRate * 0.49 / minFrequency, (double)point / (numPoints - 1));
+        const auto z = std::polar(1.0, juce::MathConstants<double>::twoPi * frequency / sampleRate);
+        const auto z1 = 1.0 / z;
+
+        Complex cascade = 1.0;
+
+        for (int i = 0; i < numSections; ++i)
+            cascade *= getResponse(sections[i], z);
+
+        Complex parallel = round(form.direct);
+
+        for (int i = 0; i < form.numSections; ++i)
+        {
+            const auto& s = form.sections[(size_t)i];
+            parallel += (round(s.c1) + round(s.c2) * z1) * z1 / (1.0 + (round(s.a1) + round(s.a2) * z1) * z1);
+        }
+
+        const auto error = std::abs(parallel - cascade) / juce::jmax(std::abs(cascade), ParallelForm::errorFloor);
+
+        // NaN, from coincident poles, has to count as the worst error there is.
+        if (! (error <= worst))
+            worst = std::isnan(error) ? std::numeric_limits<double>::infinity() : error;
+    }
+
+    return worst;
+}
+
+void ParallelForm::design(ParallelForm& form, const BiquadCoefficients<double>* sections, const juce::uint8* slots,
+                          int numSections, double sampleRate)
+{
+    RealtimeInstrumentation::noteDesign();
+
+    jassert(numSections <= maxSections);
+
+    // With the poles p in distinct pairs, H(z) = prod(b0) + sum of R / (z - p), and
+    // R / (z - p) = R z^-1 / (1 - p z^-1). Each pair of poles makes one real section.
+    form.sampleRate = sampleRate;
+    form.numSections = numSections;
+    form.direct = 1.0;
+
+    for (int k = 0; k < numSections; ++k)
+    {
+        const auto& section = sections[k];
+        const auto poles = getPoles(section.a1, section.a2);
+
+        // The residue at p, the other pole of its section being q: the section's numerator
+        // over (p - q), times the response of every other section at p.
+        auto getResidue = [&](Complex p, Complex q)
+        {
+            auto residue = ((section.b0 * p + section.b1) * p + section.b2) / (p - q);
+
+            for (int j = 0; j < numSections; ++j)
+                if (j != k)
+                    residue *= getResponse(sections[j], p);
+
+            return residue;
+        };
+
+        const auto r1 = getResidue(poles.first, poles.second);
+        const auto r2 = getResidue(poles.second, poles.first);
+
+        // R1 / (z - p1) + R2 / (z - p2) over the section's own denominator.
+        form.sections[(size_t)k] = { (r1 + r2).real(), -(r1 * poles.second + r2 * poles.first).real(), section.a1, section.a2 };
+        form.slots[(size_t)k] = slots[k];
+        form.direct *= section.b0;
+    }
+
+    form.doubleError = measureError<double>(form, sections, numSections, sampleRate);
+    form.floatError = measureError<float>(form, sections, numSections, sampleRate);
+}
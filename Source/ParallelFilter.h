@@ -0,0 +1,230 @@
+/*
+  ==============================================================================
+
+    ParallelFilter.h
+
+    A biquad cascade rewritten as a sum of second-order sections, so that the
+    sections of a single channel can share the lanes of a SIMD register.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CascadeFilter.h"
+
+//==============================================================================
+/**
+    The partial-fraction expansion of a biquad cascade,
+
+        H(z) = direct + sum of (c1 z^-1 + c2 z^-2) / (1 + a1 z^-1 + a2 z^-2),
+
+    with one parallel section per cascade section, sharing its poles. The
+    residues come from the cascade's poles, which are known section by section,
+    so nothing needs a polynomial root finder.
+
+    The expansion is exact in theory but not always in practice: coincident
+    poles, such as two identical bands, have no such expansion, and poles close
+    together give large residues that cancel. design() therefore measures the
+    worst deviation from the cascade's response, with the coefficients in double
+    and rounded to float, and isAccurate() tells the chains whether to use it.
+*/
+struct ParallelForm
+{
+    static constexpr int maxSections = 64;
+
+    /** The worst deviation from the cascade tolerated, relative to the cascade's
+        magnitude, or to errorFloor where that is lower: under 0.01 dB in the
+        pass band, and 120 dB down in a cut's stop band.
+    */
+    static constexpr double maxError = 1.0e-3;
+    static constexpr double errorFloor = 1.0e-3;
+
+    struct Section
+    {
+        double c1, c2, a1, a2;
+    };
+
+    double sampleRate{ 0.0 };
+    double direct{ 1.0 };
+    int numSections{ 0 };
+
+    // Not initialised, as the audio thread builds ChainCoefficients, which hold
+    // one of these, at up to every sample. Only the first numSections are valid.
+    std::array<Section, maxSections> sections;
+    std::array<juce::uint8, maxSections> slots;
+
+    // Infinite until design() has checked the expansion.
+    double doubleError{ std::numeric_limits<double>::infinity() };
+    double floatError{ std::numeric_limits<double>::infinity() };
+
+    template <typename NumericType>
+    bool isAccurate() const noexcept
+    {
+        return (std::is_same<NumericType, float>::value ? floatError : doubleError) <= maxError;
+    }
+
+    /** Expands the cascade of numSections sections, keeping the state slot of each,
+        and checks the result against it. Costs a few hundred complex products per
+        section, so call it off the audio thread.
+    */
+    static void design(ParallelForm& form, const BiquadCoefficients<double>* sections, const juce::uint8* slots,
+                       int numSections, double sampleRate);
+};
+
+//==============================================================================
+/**
+    Runs a ParallelForm on interleaved channel groups, one channel at a time,
+    with the sections spread across the lanes of a SIMDRegister.
+
+    A cascade is serial: each section waits for the previous one's output, and
+    a group that holds only one or two channels leaves the other lanes idle.
+    The parallel sections all see the same input sample and none of them needs
+    the current output, so a register of sections updates at once and their
+    outputs are summed across the lanes at the end.
+*/
+template <typename NumericType>
+class ParallelFilter
+{
+public:
+    using SIMDType = juce::dsp::SIMDRegister<NumericType>;
+    static constexpr auto registerSize = SIMDType::size();
+
+    /** Allocates state for numChannelGroups groups of registerSize channels. */
+    void prepare(size_t numChannelGroups)
+    {
+        state.assign(numChannelGroups * registerSize * maxVectors, State());
+        scratch.assign(maxVectors * registerSize, ScalarState());
+    }
+
+    void reset() noexcept
+    {
+        std::fill(state.begin(), state.end(), State());
+    }
+
+    /** Takes over a new expansion, in the precision of the filter. Sections that
+        keep their slot keep their state, the rest start from silence.
+        Allocation-free.
+    */
+    void setForm(const ParallelForm& form) noexcept
+    {
+        jassert(form.numSections <= ParallelForm::maxSections);
+
+        const auto newNumVectors = ((size_t)form.numSections + registerSize - 1) / registerSize;
+
+        if (! std::equal(slots.begin(), slots.begin() + numSections, form.slots.begin(), form.slots.begin() + form.numSections))
+            for (size_t chainState = 0; chainState < state.size(); chainState += maxVectors)
+                moveState(state.data() + chainState, form);
+
+        direct = static_cast<NumericType>(form.direct);
+
+        for (size_t vector = 0; vector < newNumVectors; ++vector)
+        {
+            // Unused lanes get zero coefficients, so they stay silent.
+            coefficients[vector] = Coefficients();
+
+            for (size_t lane = 0; lane < registerSize; ++lane)
+            {
+                const auto index = vector * registerSize + lane;
+
+                if (index >= (size_t)form.numSections)
+                    break;
+
+                const auto& section = form.sections[index];
+                coefficients[vector].c1.set(lane, static_cast<NumericType>(section.c1));
+                coefficients[vector].c2.set(lane, static_cast<NumericType>(section.c2));
+                coefficients[vector].a1.set(lane, static_cast<NumericType>(section.a1));
+                coefficients[vector].a2.set(lane, static_cast<NumericType>(section.a2));
+            }
+        }
+
+        std::copy_n(form.slots.begin(), form.numSections, slots.begin());
+        numSections = form.numSections;
+        numVectors = newNumVectors;
+    }
+
+    int getNumSections() const noexcept { return numSections; }
+
+    /** Filters the first numChannels channels of an interleaved group in place. */
+    void process(size_t group, SIMDType* samples, size_t numSamples, size_t numChannels) noexcept
+    {
+        auto* scalars = reinterpret_cast<NumericType*>(samples);
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* z = state.data() + (group * registerSize + channel) * maxVectors;
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                auto& sample = scalars[i * registerSize + channel];
+                const auto x = SIMDType::expand(sample);
+                auto y = SIMDType::expand(0);
+
+                // Transposed direct form II with b0 = 0, so the output is the first state.
+                for (size_t vector = 0; vector < numVectors; ++vector)
+                {
+                    const auto& c = coefficients[vector];
+                    const auto out = z[vector].s1;
+
+                    z[vector].s1 = x * c.c1 - out * c.a1 + z[vector].s2;
+                    z[vector].s2 = x * c.c2 - out * c.a2;
+                    y += out;
+                }
+
+                sample = sample * direct + y.sum();
+            }
+        }
+    }
+
+private:
+    static constexpr size_t maxVectors = ((size_t)ParallelForm::maxSections + registerSize - 1) / registerSize;
+
+    struct Coefficients
+    {
+        SIMDType c1 = SIMDType::expand(0), c2 = SIMDType::expand(0), a1 = SIMDType::expand(0), a2 = SIMDType::expand(0);
+    };
+
+    struct State
+    {
+        SIMDType s1 = SIMDType::expand(0), s2 = SIMDType::expand(0);
+    };
+
+    struct ScalarState
+    {
+        NumericType s1{ 0 }, s2{ 0 };
+    };
+
+    // Rearranges one channel's lanes of state for the sections of the new form.
+    void moveState(State* z, const ParallelForm& form) noexcept
+    {
+        for (size_t index = 0; index < maxVectors * registerSize; ++index)
+            scratch[index] = { z[index / registerSize].s1.get(index % registerSize), z[index / registerSize].s2.get(index % registerSize) };
+
+        std::fill(z, z + maxVectors, State());
+
+        for (int index = 0; index < form.numSections; ++index)
+        {
+            for (int previous = 0; previous < numSections; ++previous)
+            {
+                if (slots[(size_t)previous] == form.slots[(size_t)index])
+                {
+                    auto& lanes = z[(size_t)index / registerSize];
+                    lanes.s1.set((size_t)index % registerSize, scratch[(size_t)previous].s1);
+                    lanes.s2.set((size_t)index % registerSize, scratch[(size_t)previous].s2);
+                    break;
+                }
+            }
+        }
+    }
+
+    std::array<Coefficients, maxVectors> coefficients;
+    std::array<juce::uint8, ParallelForm::maxSections> slots{};
+    NumericType direct{ 1 };
+    int numSections{ 0 };
+    size_t numVectors{ 0 };
+
+    // maxVectors registers of state per channel, indexed by section.
+    std::vector<State> state;
+    std::vector<ScalarState> scratch;
+};
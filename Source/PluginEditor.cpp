@@ -9,13 +9,295 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+//==============================================================================
+ParameterControl::ParameterControl (juce::AudioProcessorValueTreeState& apvts, juce::RangedAudioParameter& parameter)
+{
+    label.setText (parameter.getName (32), juce::dontSendNotification);
+    label.setJustificationType (juce::Justification::centred);
+    addAndMakeVisible (label);
+
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*> (&parameter))
+    {
+        // The items have to be there before the attachment selects one.
+        comboBox = std::make_unique<juce::ComboBox>();
+        comboBox->addItemList (choice->choices, 1);
+        addAndMakeVisible (*comboBox);
+
+        comboBoxAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (apvts, parameter.paramID, *comboBox);
+        return;
+    }
+
+    slider = std::make_unique<juce::Slider> (juce::Slider::RotaryHorizontalVerticalDrag, juce::Slider::TextBoxBelow);
+    addAndMakeVisible (*slider);
+
+    sliderAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (apvts, parameter.paramID, *slider);
+}
+
+void ParameterControl::resized()
+{
+    auto bounds = getLocalBounds().reduced (2);
+    label.setBounds (bounds.removeFromTop (18));
+
+    if (comboBox != nullptr)
+        comboBox->setBounds (bounds.withSizeKeepingCentre (bounds.getWidth(), 24));
+    else
+        slider->setBounds (bounds);
+}
+
+//==============================================================================
+static constexpr float minFrequency = 20.f, maxFrequency = 20000.f;
+static constexpr float minSpectrumDecibels = -90.f, maxSpectrumDecibels = 0.f;
+static constexpr float responseDecibelsRange = 30.f;
+
+static float frequencyToX (float frequency, juce::Rectangle<float> bounds)
+{
+    return bounds.getX() + bounds.getWidth() * std::log (frequency / minFrequency) / std::log (maxFrequency / minFrequency);
+}
+
+static float xToFrequency (float x, juce::Rectangle<float> bounds)
+{
+    return minFrequency * std::pow (maxFrequency / minFrequency, (x - bounds.getX()) / bounds.getWidth());
+}
+
+static float spectrumDecibelsToY (float decibels, juce::Rectangle<float> bounds)
+{
+    return juce::jmap (juce::jlimit (minSpectrumDecibels, maxSpectrumDecibels, decibels),
+                       minSpectrumDecibels, maxSpectrumDecibels, bounds.getBottom(), bounds.getY());
+}
+
+static float responseDecibelsToY (float decibels, juce::Rectangle<float> bounds)
+{
+    return juce::jmap (juce::jlimit (-responseDecibelsRange, responseDecibelsRange, decibels),
+                       -responseDecibelsRange, responseDecibelsRange, bounds.getBottom(), bounds.getY());
+}
+
+// One point per pixel column, taking the loudest bin the column covers, so the
+// cost depends on the width rather than on the FFT size.
+static juce::Path makeSpectrumPath (const std::array<float, SpectrumAnalyzer::numBins>& decibels,
+                                    double sampleRate, juce::Rectangle<float> bounds)
+{
+    juce::Path path;
+
+    const auto binsPerHertz = (float) (SpectrumAnalyzer::fftSize / sampleRate);
+    const auto numColumns = (int) bounds.getWidth();
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        const auto x = bounds.getX() + (float) column;
+
+        const auto lowBin = juce::jlimit (1, SpectrumAnalyzer::numBins - 1, (int) (xToFrequency (x, bounds) * binsPerHertz));
+        const auto highBin = juce::jlimit (lowBin, SpectrumAnalyzer::numBins - 1, (int) (xToFrequency (x + 1.f, bounds) * binsPerHertz));
+
+        auto level = minSpectrumDecibels;
+
+        for (int bin = lowBin; bin <= highBin; ++bin)
+            level = juce::jmax (level, decibels[(size_t) bin]);
+
+        const auto y = spectrumDecibelsToY (level, bounds);
+
+        if (column == 0)
+            path.startNewSubPath (x, y);
+        else
+            path.lineTo (x, y);
+    }
+
+    return path;
+}
+
+SpectrumDisplay::SpectrumDisplay (SuperFreqAudioProcessor& p)
+    : audioProcessor (p)
+{
+    audioProcessor.getAnalyzer().start (*analyzerThread);
+    startTimerHz (SpectrumAnalyzer::frameRate);
+}
+
+SpectrumDisplay::~SpectrumDisplay()
+{
+    stopTimer();
+    audioProcessor.getAnalyzer().stop (*analyzerThread);
+}
+
+juce::Rectangle<float> SpectrumDisplay::getPlotBounds() const
+{
+    return getLocalBounds().toFloat().reduced (8.f, 6.f);
+}
+
+void SpectrumDisplay::paint (juce::Graphics& g)
+{
+    const auto bounds = getPlotBounds();
+
+    g.setColour (juce::Colours::black);
+    g.fillRect (bounds);
+
+    g.setFont (11.f);
+
+    for (auto frequency : { 20.f, 50.f, 100.f, 200.f, 500.f, 1000.f, 2000.f, 5000.f, 10000.f, 20000.f })
+    {
+        const auto x = frequencyToX (frequency, bounds);
+
+        g.setColour (juce::Colours::white.withAlpha (0.12f));
+        g.drawVerticalLine (juce::roundToInt (x), bounds.getY(), bounds.getBottom());
+
+        g.setColour (juce::Colours::white.withAlpha (0.5f));
+        g.drawText (frequency >= 1000.f ? juce::String (frequency / 1000.f) + "k" : juce::String ((int) frequency),
+                    juce::Rectangle<float> (x + 2.f, bounds.getBottom() - 14.f, 40.f, 14.f), juce::Justification::centredLeft);
+    }
+
+    for (auto decibels = maxSpectrumDecibels - 12.f; decibels > minSpectrumDecibels; decibels -= 12.f)
+    {
+        g.setColour (juce::Colours::white.withAlpha (0.08f));
+        g.drawHorizontalLine (juce::roundToInt (spectrumDecibelsToY (decibels, bounds)), bounds.getX(), bounds.getRight());
+    }
+
+    g.setColour (juce::Colours::white.withAlpha (0.2f));
+    g.drawHorizontalLine (juce::roundToInt (responseDecibelsToY (0.f, bounds)), bounds.getX(), bounds.getRight());
+
+    g.setColour (juce::Colours::skyblue.withAlpha (0.35f));
+    g.strokePath (prePath, juce::PathStrokeType (1.f));
+
+    g.setColour (juce::Colours::orange);
+    g.strokePath (postPath, juce::PathStrokeType (1.5f));
+
+    g.setColour (juce::Colours::orange.withAlpha (0.4f));
+    g.strokePath (postPeakPath, juce::PathStrokeType (1.f));
+
+    if (responseImage.isValid())
+        g.drawImage (responseImage, bounds);
+
+   #if SUPERFREQ_RT_INSTRUMENTATION
+    const auto snapshot = audioProcessor.getRealtimeInstrumentation().getSnapshot();
+
+    g.setColour (juce::Colours::white.withAlpha (0.6f));
+    g.drawText ("worst block " + juce::String (snapshot.worstLoad * 100.0, 1) + "%, "
+                    + juce::String ((juce::int64) snapshot.allocations) + " allocs, "
+                    + juce::String ((juce::int64) snapshot.mutexLocks) + " locks, "
+                    + juce::String ((juce::int64) snapshot.designs) + " designs on the audio thread",
+                bounds.reduced (4.f).removeFromTop (14.f), juce::Justification::topLeft);
+   #endif
+}
+
+void SpectrumDisplay::resized()
+{
+    // One point per physical pixel column.
+    const auto scale = juce::Component::getApproximateScaleFactorForComponent (this);
+    responseCurve.setNumPoints (juce::roundToInt (getPlotBounds().getWidth() * scale));
+
+    updatePaths();
+    renderResponse();
+}
+
+void SpectrumDisplay::timerCallback()
+{
+    auto needsRepaint = false;
+
+    if (audioProcessor.getAnalyzer().getSpectra().acquire())
+    {
+        updatePaths();
+        needsRepaint = true;
+    }
+
+    if (responseCurve.getResponses().acquire())
+    {
+        renderResponse();
+        needsRepaint = true;
+    }
+
+    if (needsRepaint)
+        repaint();
+}
+
+void SpectrumDisplay::updatePaths()
+{
+    const auto& spectrum = audioProcessor.getAnalyzer().getSpectra().getReadBuffer();
+    const auto bounds = getPlotBounds();
+
+    if (spectrum.sampleRate <= 0.0 || bounds.isEmpty())
+        return;
+
+    prePath = makeSpectrumPath (spectrum.traces[SpectrumAnalyzer::pre].average, spectrum.sampleRate, bounds);
+    postPath = makeSpectrumPath (spectrum.traces[SpectrumAnalyzer::post].average, spectrum.sampleRate, bounds);
+    postPeakPath = makeSpectrumPath (spectrum.traces[SpectrumAnalyzer::post].peak, spectrum.sampleRate, bounds);
+}
+
+void SpectrumDisplay::renderResponse()
+{
+    const auto& response = responseCurve.getResponses().getReadBuffer();
+    const auto bounds = getPlotBounds();
+
+    if (response.numPoints < 2 || bounds.isEmpty())
+        return;
+
+    const auto scale = juce::Component::getApproximateScaleFactorForComponent (this);
+    const auto width = juce::roundToInt (bounds.getWidth() * scale);
+    const auto height = juce::roundToInt (bounds.getHeight() * scale);
+
+    if (responseImage.getWidth() != width || responseImage.getHeight() != height)
+        responseImage = juce::Image (juce::Image::ARGB, width, height, true);
+    else
+        responseImage.clear (responseImage.getBounds());
+
+    // Points are log-spaced over the same range as the grid, so they are evenly spaced in x.
+    const auto area = bounds.withZeroOrigin();
+    juce::Path path;
+
+    for (int i = 0; i < response.numPoints; ++i)
+    {
+        const auto x = area.getWidth() * (float) i / (float) (response.numPoints - 1);
+        const auto y = responseDecibelsToY (response.decibels[(size_t) i], area);
+
+        if (i == 0)
+            path.startNewSubPath (x, y);
+        else
+            path.lineTo (x, y);
+    }
+
+    juce::Graphics g (responseImage);
+    g.addTransform (juce::AffineTransform::scale (scale));
+
+    g.setColour (juce::Colours::white);
+    g.strokePath (path, juce::PathStrokeType (2.f));
+}
+
 //==============================================================================
 SuperFreqAudioProcessorEditor::SuperFreqAudioProcessorEditor (SuperFreqAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p), spectrumDisplay (p)
 {
+    addAndMakeVisible (spectrumDisplay);
+
+    // Built from the parameter list, so new parameters get a control without touching the editor.
+    for (auto* parameter : audioProcessor.getParameters())
+    {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter))
+        {
+            auto control = std::make_unique<ParameterControl> (audioProcessor.apvts, *ranged);
+            auto* controls = &parameterControls;
+
+            for (int band = numFixedBands; band < maxBands; ++band)
+                if (ranged->paramID.startsWith (getBandParameterID (band, {})))
+                    controls = &bandControls[(size_t) band];
+
+            addChildComponent (*control);
+            controls->push_back (std::move (control));
+        }
+    }
+
+    for (auto& control : parameterControls)
+        control->setVisible (true);
+
+    for (int band = numFixedBands; band < maxBands; ++band)
+        bandSelector.addItem ("band" + juce::String (band + 1), band + 1);
+
+    bandSelector.onChange = [this] { showBand (bandSelector.getSelectedId() - 1); };
+    addAndMakeVisible (bandSelector);
+
+    setResizable (true, true);
+    setResizeLimits (560, 400, 1600, 1200);
+
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setSize (960, 520);
+
+    bandSelector.setSelectedId (numFixedBands + 1);
 }
 
 SuperFreqAudioProcessorEditor::~SuperFreqAudioProcessorEditor()
@@ -27,14 +309,58 @@ void SuperFreqAudioProcessorEditor::paint (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
 }
 
 void SuperFreqAudioProcessorEditor::resized()
 {
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
+    // The controls go in two rows under the display, with the selected optional
+    // band's controls after the rest, behind the band selector.
+    constexpr int numRows = 2, rowHeight = 96;
+
+    auto bounds = getLocalBounds();
+    auto controlArea = bounds.removeFromBottom (numRows * rowHeight);
+
+    spectrumDisplay.setBounds (bounds);
+
+    std::vector<juce::Component*> controls;
+
+    for (auto& control : parameterControls)
+        controls.push_back (control.get());
+
+    controls.push_back (&bandSelector);
+
+    for (auto& control : bandControls[(size_t) shownBand])
+        controls.push_back (control.get());
+
+    const auto numColumns = juce::jmax (1, ((int) controls.size() + numRows - 1) / numRows);
+    const auto columnWidth = controlArea.getWidth() / numColumns;
+
+    for (size_t i = 0; i < controls.size(); ++i)
+    {
+        const auto row = (int) i / numColumns;
+        const auto column = (int) i % numColumns;
+        const juce::Rectangle<int> cell (controlArea.getX() + column * columnWidth, controlArea.getY() + row * rowHeight,
+                                         columnWidth, rowHeight);
+
+        if (controls[i] == &bandSelector)
+            bandSelector.setBounds (cell.reduced (2).withSizeKeepingCentre (cell.getWidth() - 4, 24));
+        else
+            controls[i]->setBounds (cell);
+    }
+}
+
+void SuperFreqAudioProcessorEditor::showBand (int band)
+{
+    if (! juce::isPositiveAndBelow (band, maxBands) || band < numFixedBands)
+        return;
+
+    for (auto& control : bandControls[(size_t) shownBand])
+        control->setVisible (false);
+
+    shownBand = band;
+
+    for (auto& control : bandControls[(size_t) shownBand])
+        control->setVisible (true);
+
+    resized();
 }
@@ -10,6 +10,72 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "ResponseCurve.h"
+
+//==============================================================================
+/** A labelled control for one parameter: a combo box for a choice, a rotary
+    slider for anything else, attached to the parameter through the APVTS.
+*/
+class ParameterControl  : public juce::Component
+{
+public:
+    ParameterControl (juce::AudioProcessorValueTreeState& apvts, juce::RangedAudioParameter& parameter);
+
+    void resized() override;
+
+private:
+    juce::Label label;
+
+    std::unique_ptr<juce::Slider> slider;
+    std::unique_ptr<juce::ComboBox> comboBox;
+
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> sliderAttachment;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> comboBoxAttachment;
+
+    JUCE_DECLARE_NON_COPYABLE (ParameterControl)
+};
+
+//==============================================================================
+/** Draws the analyzer's pre and post spectra on a log-frequency grid, with the
+    chain's magnitude response over them, and keeps the analyzer and the response
+    evaluation running for as long as it is on screen.
+*/
+class SpectrumDisplay  : public juce::Component,
+                         private juce::Timer
+{
+public:
+    explicit SpectrumDisplay (SuperFreqAudioProcessor&);
+    ~SpectrumDisplay() override;
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+    void timerCallback() override;
+
+    // Rebuilds the traces from the spectrum last taken from the analyzer.
+    void updatePaths();
+
+    // Strokes the response last taken from responseCurve into responseImage.
+    void renderResponse();
+
+    juce::Rectangle<float> getPlotBounds() const;
+
+    SuperFreqAudioProcessor& audioProcessor;
+
+    // Only exists while some editor is open.
+    juce::SharedResourcePointer<AnalyzerThread> analyzerThread;
+
+    ResponseCurve responseCurve{ audioProcessor, *analyzerThread };
+
+    juce::Path prePath, postPath, postPeakPath;
+
+    // The response only changes with the parameters, so it is drawn once at the
+    // display's physical resolution and then just blitted with every spectrum frame.
+    juce::Image responseImage;
+
+    JUCE_DECLARE_NON_COPYABLE (SpectrumDisplay)
+};
 
 //==============================================================================
 /**
@@ -29,5 +95,17 @@ private:
     // access the processor object that created it.
     SuperFreqAudioProcessor& audioProcessor;
 
+    SpectrumDisplay spectrumDisplay;
+
+    void showBand (int band);
+
+    // One per parameter, in the order the parameter layout declares them,
+    // except for the optional bands, whose controls are shown one band at a time.
+    std::vector<std::unique_ptr<ParameterControl>> parameterControls;
+    std::array<std::vector<std::unique_ptr<ParameterControl>>, maxBands> bandControls;
+
+    juce::ComboBox bandSelector;
+    int shownBand{ numFixedBands };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SuperFreqAudioProcessorEditor)
 };
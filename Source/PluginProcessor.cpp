@@ -16,93 +16,1032 @@ SuperFreqAudioProcessor::SuperFreqAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        )
 #endif
 {
+    for (auto* parameter : getParameters())
+        if (auto* parameterWithID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter))
+            apvts.addParameterListener(parameterWithID->paramID, this);
+
+    controlRate = apvts.getRawParameterValue("control rate");
+    processingMode = apvts.getRawParameterValue("processing mode");
+    oversampling = apvts.getRawParameterValue("oversampling");
+    precision = apvts.getRawParameterValue("precision");
+    band2Dynamics = apvts.getRawParameterValue("band2 dynamics");
+    channelThreads = apvts.getRawParameterValue("channel threads");
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        auto& parameters = controlledParameters[(size_t)band];
+        parameters[0] = apvts.getParameter(getBandParameterID(band, "freq"));
+        parameters[1] = apvts.getParameter(getBandParameterID(band, "gain"));
+        parameters[2] = apvts.getParameter(getBandParameterID(band, "q"));
+    }
+
+    designThread->addTimeSliceClient(this);
+
+    // Controller values reach the host at about the rate an editor repaints.
+    startTimerHz(30);
+
+   #if SUPERFREQ_RT_INSTRUMENTATION
+    if (rtInstrumentation.getReportFile() != juce::File())
+        designThread->addTimeSliceClient(&rtInstrumentation);
+   #endif
+}
+
+SuperFreqAudioProcessor::~SuperFreqAudioProcessor()
+{
+    stopTimer();
+
+   #if SUPERFREQ_RT_INSTRUMENTATION
+    designThread->removeTimeSliceClient(&rtInstrumentation);
+   #endif
+
+    designThread->removeTimeSliceClient(this);
+
+    for (auto* parameter : getParameters())
+        if (auto* parameterWithID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter))
+            apvts.removeParameterListener(parameterWithID->paramID, this);
+}
+
+//==============================================================================
+const juce::String SuperFreqAudioProcessor::getName() const
+{
+    return JucePlugin_Name;
+}
+
+bool SuperFreqAudioProcessor::acceptsMidi() const
+{
+   #if JucePlugin_WantsMidiInput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool SuperFreqAudioProcessor::producesMidi() const
+{
+   #if JucePlugin_ProducesMidiOutput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool SuperFreqAudioProcessor::isMidiEffect() const
+{
+   #if JucePlugin_IsMidiEffect
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+double SuperFreqAudioProcessor::getTailLengthSeconds() const
+{
+    // Follows the bands from prepareToPlay on.
+    return tailLengthSeconds.load();
+}
+
+int SuperFreqAudioProcessor::getNumPrograms()
+{
+    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                // so this should be at least 1, even if you're not really implementing programs.
+}
+
+int SuperFreqAudioProcessor::getCurrentProgram()
+{
+    return 0;
+}
+
+void SuperFreqAudioProcessor::setCurrentProgram (int index)
+{
+}
+
+const juce::String SuperFreqAudioProcessor::getProgramName (int index)
+{
+    return {};
+}
+
+void SuperFreqAudioProcessor::changeProgramName (int index, const juce::String& newName)
+{
+}
+
+juce::String getBandParameterID(int band, const juce::String& name)
+{
+    return "band" + juce::String(band + 1) + " " + name;
+}
+
+ChainParameters::ChainParameters(juce::AudioProcessorValueTreeState& apvts)
+{
+    for (int band = 0; band < maxBands; ++band)
+    {
+        auto& parameters = bands[(size_t)band];
+
+        // Null for the parameters a band doesn't have.
+        parameters.type = apvts.getRawParameterValue(getBandParameterID(band, "type"));
+        parameters.freq = apvts.getRawParameterValue(getBandParameterID(band, "freq"));
+        parameters.gain = apvts.getRawParameterValue(getBandParameterID(band, "gain"));
+        parameters.q = apvts.getRawParameterValue(getBandParameterID(band, "q"));
+        parameters.slope = apvts.getRawParameterValue(getBandParameterID(band, "slope"));
+
+        for (auto& controllerValue : parameters.controllerValues)
+            controllerValue.store(std::numeric_limits<float>::quiet_NaN());
+    }
+
+    processingMode = apvts.getRawParameterValue("processing mode");
+    band2Dynamics = apvts.getRawParameterValue("band2 dynamics");
+    band2Threshold = apvts.getRawParameterValue("band2 threshold");
+    band2Ratio = apvts.getRawParameterValue("band2 ratio");
+    band2Attack = apvts.getRawParameterValue("band2 attack");
+    band2Release = apvts.getRawParameterValue("band2 release");
+}
+
+// A MIDI controller's value while one is on its way to the host, otherwise the parameter's.
+static float loadControlled(const std::atomic<float>& parameter, const std::atomic<float>& controllerValue) noexcept
+{
+    const auto value = controllerValue.load();
+    return std::isnan(value) ? parameter.load() : value;
+}
+
+ChainSettings getChainSettings(const ChainParameters& chainParameters)
+{
+    static constexpr BandType fixedBandTypes[numFixedBands]{ BandType::Band_LowCut, BandType::Band_Bell, BandType::Band_HighCut };
+
+    ChainSettings settings;
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        const auto& parameters = chainParameters.bands[(size_t)band];
+        auto& bandSettings = settings.bands[(size_t)band];
+
+        bandSettings.type = band < numFixedBands ? fixedBandTypes[band] : static_cast<BandType>(parameters.type->load());
+        bandSettings.freq = loadControlled(*parameters.freq, parameters.controllerValues[0]);
+
+        if (parameters.gain != nullptr)
+            bandSettings.gain = loadControlled(*parameters.gain, parameters.controllerValues[1]);
+
+        if (parameters.q != nullptr)
+            bandSettings.q = loadControlled(*parameters.q, parameters.controllerValues[2]);
+
+        if (parameters.slope != nullptr)
+            bandSettings.slope = static_cast<Slope>(parameters.slope->load());
+    }
+
+    settings.processingMode = static_cast<ProcessingMode>(chainParameters.processingMode->load());
+    settings.band2Dynamics = static_cast<Band2Dynamics>(chainParameters.band2Dynamics->load());
+    settings.band2Threshold = chainParameters.band2Threshold->load();
+    settings.band2Ratio = chainParameters.band2Ratio->load();
+    settings.band2Attack = chainParameters.band2Attack->load();
+    settings.band2Release = chainParameters.band2Release->load();
+
+    return settings;
+}
+
+bool BandSettings::hasGain() const noexcept
+{
+    return type == BandType::Band_Bell || type == BandType::Band_LowShelf || type == BandType::Band_HighShelf;
+}
+
+bool BandSettings::isIdentity() const noexcept
+{
+    return type == BandType::Band_Off || (hasGain() && std::abs(gain) < identityGainDecibels);
+}
+
+int BandSettings::getNumSections() const noexcept
+{
+    // Identity bands are left out of every design, so they cost nothing to run.
+    if (isIdentity())
+        return 0;
+
+    switch (type)
+    {
+        case BandType::Band_LowCut:
+        case BandType::Band_HighCut:  return slope + 1;
+        default:                      return 1;
+    }
+}
+
+static BiquadCoefficients<double> makeBiquadCoefficients(const std::array<double, 6>& coefficients)
+{
+    // ArrayCoefficients come as { b0, b1, b2, a0, a1, a2 }, not yet normalised.
+    const auto a0Inv = 1.0 / coefficients[3];
+
+    return { coefficients[0] * a0Inv, coefficients[1] * a0Inv, coefficients[2] * a0Inv,
+             coefficients[4] * a0Inv, coefficients[5] * a0Inv };
+}
+
+// Section Qs of an even-order Butterworth cascade, 1 / (2 cos((2i + 1) pi / 2N)),
+// as FilterDesign's HighOrderButterworthMethod computes them.
+static constexpr double butterworthQs[maxCutStages][maxCutStages] =
+{
+    { 0.70710678118654752 },
+    { 0.54119610014619698, 1.30656296487637652 },
+    { 0.51763809020504152, 0.70710678118654752, 1.93185165257813657 },
+    { 0.50979557910415916, 0.60134488693504528, 0.89997622313641570, 2.56291544774150617 }
+};
+
+static double prewarp(double frequency, double sampleRate)
+{
+    return std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+}
+
+// One section of a band. The cuts are the sections FilterDesign's
+// HighOrderButterworthMethod designs for an even order, built directly so that
+// nothing is allocated.
+static BiquadCoefficients<double> makeBiquadSection(const BandSettings& band, int stage, double frequency, double sampleRate)
+{
+    using Coefficients = juce::dsp::IIR::ArrayCoefficients<double>;
+
+    const auto gain = juce::Decibels::decibelsToGain((double)band.gain);
+
+    switch (band.type)
+    {
+        case BandType::Band_LowShelf:  return makeBiquadCoefficients(Coefficients::makeLowShelf(sampleRate, frequency, (double)band.q, gain));
+        case BandType::Band_HighShelf: return makeBiquadCoefficients(Coefficients::makeHighShelf(sampleRate, frequency, (double)band.q, gain));
+        case BandType::Band_LowCut:    return makeBiquadCoefficients(Coefficients::makeHighPass(sampleRate, frequency, butterworthQs[band.slope][stage]));
+        case BandType::Band_HighCut:   return makeBiquadCoefficients(Coefficients::makeLowPass(sampleRate, frequency, butterworthQs[band.slope][stage]));
+        case BandType::Band_Bell:
+        case BandType::Band_Off:
+        default:                       return makeBiquadCoefficients(Coefficients::makePeakFilter(sampleRate, frequency, (double)band.q, gain));
+    }
+}
+
+// The same section in state-variable form. Every section of a Butterworth
+// cascade shares g; only the damping differs.
+static SvfCoefficients<double> makeSvfSection(const BandSettings& band, int stage, double frequency, double sampleRate)
+{
+    const auto g = prewarp(frequency, sampleRate);
+    const auto a = juce::Decibels::decibelsToGain(band.gain * 0.5);
+
+    switch (band.type)
+    {
+        case BandType::Band_LowShelf:  return SvfCoefficients<double>::makeLowShelf(g, 1.0 / band.q, a);
+        case BandType::Band_HighShelf: return SvfCoefficients<double>::makeHighShelf(g, 1.0 / band.q, a);
+        case BandType::Band_LowCut:    return SvfCoefficients<double>::makeHighPass(g, 1.0 / butterworthQs[band.slope][stage]);
+        case BandType::Band_HighCut:   return SvfCoefficients<double>::makeLowPass(g, 1.0 / butterworthQs[band.slope][stage]);
+        case BandType::Band_Bell:
+        case BandType::Band_Off:
+        default:                       return SvfCoefficients<double>::makePeak(g, 1.0 / band.q, a);
+    }
+}
+
+static ProcessingMode getChainMode(const ChainSettings& chainSettings) noexcept
+{
+    switch (chainSettings.processingMode)
+    {
+        case ProcessingMode::Mode_Svf:      return ProcessingMode::Mode_Svf;
+        case ProcessingMode::Mode_Parallel: return ProcessingMode::Mode_Parallel;
+        default:                            return ProcessingMode::Mode_Biquad;
+    }
+}
+
+static juce::uint8 getSlot(int band, int stage) noexcept
+{
+    return (juce::uint8)(band * maxCutStages + stage);
+}
+
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate)
+{
+    RealtimeInstrumentation::noteDesign();
+
+    // The designs break down at or above Nyquist, which low sample rates can reach.
+    const auto maxFrequency = sampleRate * 0.49;
+
+    ChainCoefficients chainCoefficients;
+    chainCoefficients.sampleRate = sampleRate;
+    chainCoefficients.mode = getChainMode(chainSettings);
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        const auto& bandSettings = chainSettings.bands[(size_t)band];
+        const auto frequency = juce::jmin((double)bandSettings.freq, maxFrequency);
+
+        if (bandSettings.getNumSections() > 0)
+            chainCoefficients.activeBands |= 1u << band;
+
+        for (int stage = 0; stage < bandSettings.getNumSections(); ++stage)
+        {
+            const auto index = (size_t)chainCoefficients.numSections++;
+            chainCoefficients.slots[index] = getSlot(band, stage);
+
+            if (chainCoefficients.mode == ProcessingMode::Mode_Svf)
+                chainCoefficients.svfSections[index] = makeSvfSection(bandSettings, stage, frequency, sampleRate);
+            else
+                chainCoefficients.sections[index] = makeBiquadSection(bandSettings, stage, frequency, sampleRate);
+        }
+    }
+
+    return chainCoefficients;
+}
+
+// Appends a band's sections as FastCoefficientMath prototypes, with their slots.
+static void addFastSections(const BandSettings& band, int bandIndex, float maxFrequency,
+                            FastCoefficientMath::Section* sections, juce::uint8* slots, int& numSections) noexcept
+{
+    const auto frequency = juce::jmin(band.freq, maxFrequency);
+
+    for (int stage = 0; stage < band.getNumSections(); ++stage)
+    {
+        FastCoefficientMath::Section section{ frequency, band.q, band.gain };
+
+        switch (band.type)
+        {
+            case BandType::Band_LowShelf:  section.lowShelf = 1.f; break;
+            case BandType::Band_HighShelf: section.highShelf = 1.f; break;
+
+            case BandType::Band_LowCut:
+            case BandType::Band_HighCut:
+                section.q = (float)butterworthQs[band.slope][stage];
+                section.gainDecibels = 0.f;
+                section.highPass = band.type == BandType::Band_LowCut ? 1.f : 0.f;
+                section.lowPass = band.type == BandType::Band_HighCut ? 1.f : 0.f;
+                break;
+
+            case BandType::Band_Bell:
+            case BandType::Band_Off:
+            default:
+                section.highPass = section.bell = section.lowPass = 1.f;
+                break;
+        }
+
+        slots[numSections] = getSlot(bandIndex, stage);
+        sections[numSections++] = section;
+    }
+}
+
+// Designs the prototypes in SIMD batches, straight into the mode's coefficients.
+static void designFastSections(const FastCoefficientMath::Section* sections, const juce::uint8* slots, int numSections,
+                               double sampleRate, ChainCoefficients& chainCoefficients) noexcept
+{
+    chainCoefficients.sampleRate = sampleRate;
+    chainCoefficients.numSections = numSections;
+    std::copy_n(slots, numSections, chainCoefficients.slots.begin());
+
+    for (int i = 0; i < numSections; ++i)
+        chainCoefficients.activeBands |= 1u << (slots[i] / maxCutStages);
+
+    if (chainCoefficients.mode == ProcessingMode::Mode_Svf)
+        FastCoefficientMath::designSvfSections(sections, chainCoefficients.svfSections.data(), numSections, sampleRate);
+    else
+        FastCoefficientMath::designSections(sections, chainCoefficients.sections.data(), numSections, sampleRate);
+}
+
+ChainCoefficients makeChainCoefficientsFast(const ChainSettings& chainSettings, double sampleRate) noexcept
+{
+    const auto maxFrequency = static_cast<float>(sampleRate * 0.49);
+
+    // Every section of every band goes through one batch, so they share the SIMD lanes.
+    std::array<FastCoefficientMath::Section, maxSections> sections;
+    std::array<juce::uint8, maxSections> slots;
+    int numSections = 0;
+
+    for (int band = 0; band < maxBands; ++band)
+        addFastSections(chainSettings.bands[(size_t)band], band, maxFrequency, sections.data(), slots.data(), numSections);
+
+    ChainCoefficients chainCoefficients;
+    chainCoefficients.mode = getChainMode(chainSettings);
+    designFastSections(sections.data(), slots.data(), numSections, sampleRate, chainCoefficients);
+
+    return chainCoefficients;
+}
+
+void makeBandCoefficientsFast(const ChainSettings& chainSettings, juce::uint32 bands, double sampleRate,
+                              ChainCoefficients& chainCoefficients) noexcept
+{
+    const auto maxFrequency = static_cast<float>(sampleRate * 0.49);
+
+    std::array<FastCoefficientMath::Section, maxSections> sections;
+    std::array<juce::uint8, maxSections> slots;
+    int numSections = 0;
+
+    for (int band = 0; band < maxBands; ++band)
+        if (((bands >> band) & 1) != 0)
+            addFastSections(chainSettings.bands[(size_t)band], band, maxFrequency, sections.data(), slots.data(), numSections);
+
+    chainCoefficients.mode = getChainMode(chainSettings);
+    chainCoefficients.activeBands = 0;
+    designFastSections(sections.data(), slots.data(), numSections, sampleRate, chainCoefficients);
+}
+
+// Adds the partial-fraction expansion to a design for the parallel mode. Too slow
+// for the audio thread, so only the design thread and prepareToPlay call it.
+static void expandParallelForm(ChainCoefficients& chainCoefficients)
+{
+    if (chainCoefficients.mode == ProcessingMode::Mode_Parallel)
+        ParallelForm::design(chainCoefficients.parallel, chainCoefficients.sections.data(), chainCoefficients.slots.data(),
+                             chainCoefficients.numSections, chainCoefficients.sampleRate);
+}
+
+// The radius of a section's slowest pole, the larger root of z^2 + a1 z + a2.
+static double getPoleRadius(const BiquadCoefficients<double>& c) noexcept
+{
+    const auto discriminant = c.a1 * c.a1 - 4.0 * c.a2;
+
+    if (discriminant < 0.0)
+        return std::sqrt(c.a2);
+
+    return 0.5 * (std::abs(c.a1) + std::sqrt(discriminant));
+}
+
+// How long the bands that are on take to ring down by decayGain. Each section's
+// impulse response decays as r^n, r being the radius of its slowest pole, and
+// a cascade rings for at most about as long as its sections put together.
+static double getChainTailSeconds(const ChainSettings& chainSettings, double sampleRate, double decayGain)
+{
+    // Only rounding could put a pole on the unit circle, but it mustn't make the tail endless.
+    constexpr double maxSectionTailSeconds = 10.0;
+
+    const auto maxFrequency = sampleRate * 0.49;
+    auto tailSeconds = 0.0;
+
+    for (const auto& bandSettings : chainSettings.bands)
+    {
+        const auto frequency = juce::jmin((double)bandSettings.freq, maxFrequency);
+
+        for (int stage = 0; stage < bandSettings.getNumSections(); ++stage)
+        {
+            const auto radius = getPoleRadius(makeBiquadSection(bandSettings, stage, frequency, sampleRate));
+
+            if (radius >= 1.0)
+                tailSeconds += maxSectionTailSeconds;
+            else if (radius > 0.0)
+                tailSeconds += juce::jmin(maxSectionTailSeconds, std::log(decayGain) / std::log(radius) / sampleRate);
+        }
+    }
+
+    return tailSeconds;
+}
+
+//==============================================================================
+void ChainSmoother::reset(double sampleRate, double rampLengthInSeconds)
+{
+    for (int band = 0; band < maxBands; ++band)
+    {
+        freq[(size_t)band].reset(sampleRate, rampLengthInSeconds);
+        gain[(size_t)band].reset(sampleRate, rampLengthInSeconds);
+        q[(size_t)band].reset(sampleRate, rampLengthInSeconds);
+    }
+}
+
+void ChainSmoother::setCurrentAndTargetValue(const ChainSettings& chainSettings)
+{
+    target = chainSettings;
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        const auto& bandSettings = chainSettings.bands[(size_t)band];
+
+        freq[(size_t)band].setCurrentAndTargetValue(bandSettings.freq);
+        gain[(size_t)band].setCurrentAndTargetValue(bandSettings.gain);
+        q[(size_t)band].setCurrentAndTargetValue(bandSettings.q);
+    }
+}
+
+void ChainSmoother::setTargetValue(const ChainSettings& chainSettings)
+{
+    for (int band = 0; band < maxBands; ++band)
+    {
+        const auto& bandSettings = chainSettings.bands[(size_t)band];
+
+        // A band that is switched on starts where it is set rather than sweeping in from where it was left,
+        // except that a bell or shelf fades in from 0 dB, where it is a pass-through.
+        if (target.bands[(size_t)band].type == BandType::Band_Off)
+        {
+            freq[(size_t)band].setCurrentAndTargetValue(bandSettings.freq);
+            q[(size_t)band].setCurrentAndTargetValue(bandSettings.q);
+
+            if (bandSettings.hasGain())
+            {
+                gain[(size_t)band].setCurrentAndTargetValue(0.f);
+                gain[(size_t)band].setTargetValue(bandSettings.gain);
+            }
+            else
+            {
+                gain[(size_t)band].setCurrentAndTargetValue(bandSettings.gain);
+            }
+        }
+        else
+        {
+            freq[(size_t)band].setTargetValue(bandSettings.freq);
+            gain[(size_t)band].setTargetValue(bandSettings.gain);
+            q[(size_t)band].setTargetValue(bandSettings.q);
+        }
+    }
+
+    target = chainSettings;
+}
+
+juce::uint32 ChainSmoother::getMovingBands() const noexcept
+{
+    // Bands that are off can ramp all they like without anything to redesign.
+    juce::uint32 bands = 0;
+
+    for (int band = 0; band < maxBands; ++band)
+        if (target.bands[(size_t)band].type != BandType::Band_Off
+            && (freq[(size_t)band].isSmoothing() || gain[(size_t)band].isSmoothing() || q[(size_t)band].isSmoothing()))
+            bands |= 1u << band;
+
+    return bands;
+}
+
+ChainSettings ChainSmoother::skip(int numSamples) noexcept
+{
+    auto chainSettings = target;
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        auto& bandSettings = chainSettings.bands[(size_t)band];
+
+        bandSettings.freq = freq[(size_t)band].skip(numSamples);
+        bandSettings.gain = gain[(size_t)band].skip(numSamples);
+        bandSettings.q = q[(size_t)band].skip(numSamples);
+    }
+
+    return chainSettings;
+}
+
+//==============================================================================
+template <typename NumericType>
+void InterleavedChains<NumericType>::prepare(int numChannels, int samplesPerBlock, int newOversamplingStages)
+{
+    numChannelGroups = getNumChannelGroups((size_t)numChannels);
+
+    oversamplers.resize(numChannelGroups);
+
+    // Sized for the highest factor, so the parameter can change during playback.
+    for (auto& oversampler : oversamplers)
+        oversampler.prepare((size_t)samplesPerBlock);
+
+    biquads.prepare(numChannelGroups);
+    svfs.prepare(numChannelGroups);
+    parallel.prepare(numChannelGroups);
+
+    interleaved = juce::dsp::AudioBlock<SIMDType>(interleavedData, numChannelGroups, (size_t)samplesPerBlock);
+    interleaved.clear();
+
+    setOversamplingStages(newOversamplingStages);
+}
+
+template <typename NumericType>
+void InterleavedChains<NumericType>::reset() noexcept
+{
+    biquads.reset();
+    svfs.reset();
+    parallel.reset();
+
+    for (auto& oversampler : oversamplers)
+        oversampler.reset();
+}
+
+template <typename NumericType>
+void InterleavedChains<NumericType>::setOversamplingStages(int newOversamplingStages) noexcept
+{
+    oversamplingStages = newOversamplingStages;
+
+    for (auto& oversampler : oversamplers)
+        oversampler.setNumStages(juce::jmax(1, oversamplingStages));
+
+    reset();
+}
+
+template <typename NumericType>
+ProcessingMode InterleavedChains<NumericType>::getEngine(const ChainCoefficients& chainCoefficients) noexcept
+{
+    if (chainCoefficients.mode == ProcessingMode::Mode_Parallel && ! chainCoefficients.parallel.template isAccurate<NumericType>())
+        return ProcessingMode::Mode_Biquad;
+
+    return chainCoefficients.mode;
+}
+
+template <typename NumericType>
+int InterleavedChains<NumericType>::getNumActiveSections() const noexcept
+{
+    if (activeMode == ProcessingMode::Mode_Svf)
+        return svfs.getNumActiveSections();
+
+    if (activeMode == ProcessingMode::Mode_Parallel)
+        return parallel.getNumSections();
+
+    return biquads.getNumActiveSections();
+}
+
+template <typename NumericType>
+void InterleavedChains<NumericType>::applyCoefficients(const ChainCoefficients& chainCoefficients) noexcept
+{
+    const auto engine = getEngine(chainCoefficients);
+
+    if (engine != activeMode)
+    {
+        // The engine that takes over has been idle, so its state is stale.
+        activeMode = engine;
+
+        if (activeMode == ProcessingMode::Mode_Svf)
+            svfs.reset();
+        else if (activeMode == ProcessingMode::Mode_Parallel)
+            parallel.reset();
+        else
+            biquads.reset();
+    }
+
+    if (activeMode == ProcessingMode::Mode_Svf)
+        svfs.setSections(chainCoefficients.svfSections.data(), chainCoefficients.slots.data(), chainCoefficients.numSections);
+    else if (activeMode == ProcessingMode::Mode_Parallel)
+        parallel.setForm(chainCoefficients.parallel);
+    else
+        biquads.setSections(chainCoefficients.sections.data(), chainCoefficients.slots.data(), chainCoefficients.numSections);
+}
+
+template <typename NumericType>
+void InterleavedChains<NumericType>::updateCoefficients(const ChainCoefficients& chainCoefficients) noexcept
+{
+    // Only a full design can switch engines, and partial ones are never expanded.
+    if (getEngine(chainCoefficients) != activeMode || activeMode == ProcessingMode::Mode_Parallel)
+        return;
+
+    if (activeMode == ProcessingMode::Mode_Svf)
+        svfs.updateSections(chainCoefficients.svfSections.data(), chainCoefficients.slots.data(), chainCoefficients.numSections);
+    else
+        biquads.updateSections(chainCoefficients.sections.data(), chainCoefficients.slots.data(), chainCoefficients.numSections);
+}
+
+template <typename NumericType>
+template <typename SampleType>
+void InterleavedChains<NumericType>::process(juce::dsp::AudioBlock<SampleType> block) noexcept
+{
+    // With every band elided the block is already the output; the oversamplers
+    // still run if they are on, as their latency is reported.
+    if (getNumActiveSections() == 0 && oversamplingStages == 0)
+        return;
+
+    // Hosts may occasionally exceed the block size they prepared us with.
+    const auto maxChunkSize = interleaved.getNumSamples();
+
+    for (size_t start = 0; start < block.getNumSamples(); start += maxChunkSize)
+        processInterleaved(block.getSubBlock(start, juce::jmin(maxChunkSize, block.getNumSamples() - start)));
+}
+
+template <typename NumericType>
+template <typename SampleType>
+void InterleavedChains<NumericType>::processInterleaved(juce::dsp::AudioBlock<SampleType> block) noexcept
+{
+    const auto numGroups = juce::jmin(getNumChannelGroups(block.getNumChannels()), numChannelGroups);
+
+    auto processGroupOfBlock = [this, block](int group) { processGroup((size_t)group, block); };
+
+    // Small pieces, such as the smoothed mode's control-rate ones, go faster on one thread.
+    const auto workPerGroup = (block.getNumSamples() << oversamplingStages) * (size_t)juce::jmax(1, getNumActiveSections());
+
+    if (workerPool != nullptr && numGroups > 1 && workPerGroup >= minWorkPerGroup)
+    {
+        workerPool->parallelFor((int)numGroups, processGroupOfBlock);
+        return;
+    }
+
+    for (size_t group = 0; group < numGroups; ++group)
+        processGroup(group, block);
+}
+
+template <typename NumericType>
+template <typename SampleType>
+void InterleavedChains<NumericType>::processGroup(size_t group, juce::dsp::AudioBlock<SampleType> block) noexcept
+{
+    const auto numSamples = block.getNumSamples();
+    const auto firstChannel = group * registerSize;
+    const auto numLanes = juce::jmin(registerSize, block.getNumChannels() - firstChannel);
+
+    auto* lanes = reinterpret_cast<NumericType*>(interleaved.getChannelPointer(group));
+
+    // Converting here, while interleaving, is what lets float and double buffers share the chains.
+    for (size_t lane = 0; lane < numLanes; ++lane)
+    {
+        auto* source = block.getChannelPointer(firstChannel + lane);
+
+        for (size_t i = 0; i < numSamples; ++i)
+            lanes[i * registerSize + lane] = static_cast<NumericType>(source[i]);
+    }
+
+    // Unused lanes of the last group stay at the silence written in prepareToPlay,
+    // and filtering silence from a silent state keeps them there.
+    auto groupBlock = interleaved.getSingleChannelBlock(group).getSubBlock(0, numSamples);
+    auto chainBlock = oversamplingStages > 0 ? oversamplers[group].processSamplesUp(groupBlock) : groupBlock;
+
+    if (activeMode == ProcessingMode::Mode_Svf)
+        svfs.process(group, chainBlock.getChannelPointer(0), chainBlock.getNumSamples());
+    else if (activeMode == ProcessingMode::Mode_Parallel)
+        parallel.process(group, chainBlock.getChannelPointer(0), chainBlock.getNumSamples(), numLanes);
+    else
+        biquads.process(group, chainBlock.getChannelPointer(0), chainBlock.getNumSamples());
+
+    if (oversamplingStages > 0)
+        oversamplers[group].processSamplesDown(groupBlock);
+
+    for (size_t lane = 0; lane < numLanes; ++lane)
+    {
+        auto* destination = block.getChannelPointer(firstChannel + lane);
+
+        for (size_t i = 0; i < numSamples; ++i)
+            destination[i] = static_cast<SampleType>(lanes[i * registerSize + lane]);
+    }
+}
+
+template class InterleavedChains<float>;
+template class InterleavedChains<double>;
+
+//==============================================================================
+void SuperFreqAudioProcessor::parameterChanged(const juce::String&, float)
+{
+    // May be called from the audio thread during automation, so this only flags the change.
+    parametersVersion.fetch_add(1, std::memory_order_release);
+}
+
+int SuperFreqAudioProcessor::useTimeSlice()
+{
+    const auto sampleRate = designSampleRate.load();
+    const auto version = parametersVersion.load(std::memory_order_acquire);
+
+    // The smoothed mode designs on the audio thread instead.
+    const auto isBlockRate = getControlInterval() == 0;
+    const auto chainSampleRate = sampleRate * (1 << getOversamplingStages());
+
+    if (isBlockRate && sampleRate > 0.0 && (version != designedParametersVersion || chainSampleRate != designedSampleRate))
+    {
+        designedParametersVersion = version;
+        designedSampleRate = chainSampleRate;
+
+        auto& chainCoefficients = coefficientSets.getWriteBuffer();
+        chainCoefficients = makeChainCoefficients(getChainSettings(chainParameters), chainSampleRate);
+        chainCoefficients.parametersVersion = version;
+        expandParallelForm(chainCoefficients);
+        coefficientSets.publish();
+    }
+
+    const auto mode = getProcessingMode();
+
+    if (mode == ProcessingMode::Mode_LinearPhase && sampleRate > 0.0)
+    {
+        const juce::ScopedLock sl(linearPhaseLock);
+        updateLinearPhase(version, sampleRate);
+    }
+
+    if (sampleRate > 0.0 && (version != tailParametersVersion || sampleRate != tailSampleRate))
+    {
+        tailParametersVersion = version;
+        tailSampleRate = sampleRate;
+
+        updateTailLength(getChainSettings(chainParameters), sampleRate);
+    }
+
+    // setLatencySamples calls back into the host, so the timer reports it. The
+    // oversampling latency it reads off the parameter itself.
+    if (mode == ProcessingMode::Mode_LinearPhase && sampleRate > 0.0)
+        linearPhaseLatencySamples.store(LinearPhaseFilter::getLatencyInSamples(sampleRate));
+
+    // A worker for every channel group past the audio thread's own, as far as the cores
+    // and the pool go, but only while they are asked for.
+    const auto numWorkers = channelThreads->load() > 0.5f ? juce::jmin(numChannelGroups.load(), juce::SystemStats::getNumCpus()) - 1 : 0;
+    workerPool.setNumWorkers(numWorkers);
+
+    // Picks up automation within a few milliseconds without keeping the thread busy.
+    return 5;
+}
+
+int SuperFreqAudioProcessor::getControlInterval() const noexcept
+{
+    return controlIntervals[(size_t)juce::jlimit(0, (int)controlIntervals.size() - 1, (int)controlRate->load())];
+}
+
+ProcessingMode SuperFreqAudioProcessor::getProcessingMode() const noexcept
+{
+    return static_cast<ProcessingMode>(processingMode->load());
+}
+
+bool SuperFreqAudioProcessor::usesDoublePrecisionState() const noexcept
+{
+    return precision->load() > 0.5f;
+}
+
+int SuperFreqAudioProcessor::getOversamplingStages() const noexcept
+{
+    return juce::jlimit(0, HalfBandStages::maxStages, (int)oversampling->load());
+}
+
+double SuperFreqAudioProcessor::getDesignSampleRate() const noexcept
+{
+    return designSampleRate.load() * (1 << getOversamplingStages());
+}
+
+int SuperFreqAudioProcessor::getLatencyInSamples(ProcessingMode mode) const noexcept
+{
+    return mode == ProcessingMode::Mode_LinearPhase ? linearPhaseLatencySamples.load()
+                                                    : juce::roundToInt(HalfBandStages::getLatencyInSamples(getOversamplingStages()));
 }
 
-SuperFreqAudioProcessor::~SuperFreqAudioProcessor()
+void SuperFreqAudioProcessor::updateTailLength(const ChainSettings& chainSettings, double sampleRate)
 {
+    // The linear-phase FIR rings for its own length. The IIR modes ring through
+    // their poles, which decay in the same time at any rate, and then through the
+    // oversampling filters.
+    const auto tailSamples = chainSettings.processingMode == ProcessingMode::Mode_LinearPhase
+                                 ? 2.0 * LinearPhaseFilter::getLatencyInSamples(sampleRate)
+                                 : getChainTailSeconds(chainSettings, sampleRate, silenceThreshold) * sampleRate
+                                       + HalfBandStages::getLatencyInSamples(getOversamplingStages());
+
+    tailLengthSamples.store((int)std::ceil(tailSamples));
+    tailLengthSeconds.store(tailSamples / sampleRate);
 }
 
-//==============================================================================
-const juce::String SuperFreqAudioProcessor::getName() const
+void SuperFreqAudioProcessor::updateLinearPhase(juce::uint32 version, double sampleRate)
 {
-    return JucePlugin_Name;
+    if (linearPhaseNumChannels != linearPhaseFilterNumChannels || sampleRate != linearPhaseFilterSampleRate)
+    {
+        linearPhaseFilterNumChannels = linearPhaseNumChannels;
+        linearPhaseFilterSampleRate = sampleRate;
+
+        // Replacing the slot's old filter, if any, frees it here rather than on the audio thread.
+        auto& filter = linearPhaseFilters.getWriteBuffer();
+        filter = std::make_unique<LinearPhaseFilter>();
+        filter->prepare(linearPhaseNumChannels, sampleRate);
+        linearPhaseFilters.publish();
+    }
+
+    if (version != linearPhaseParametersVersion || sampleRate != linearPhaseSampleRate)
+    {
+        linearPhaseParametersVersion = version;
+        linearPhaseSampleRate = sampleRate;
+
+        const auto chainCoefficients = makeChainCoefficients(getChainSettings(chainParameters), sampleRate);
+
+        LinearPhaseFilter::designKernel(linearPhaseKernels.getWriteBuffer(), chainCoefficients.sections.data(),
+                                        chainCoefficients.numSections, sampleRate);
+        linearPhaseKernels.publish();
+    }
 }
 
-bool SuperFreqAudioProcessor::acceptsMidi() const
+LinearPhaseFilter* SuperFreqAudioProcessor::getLinearPhaseFilter() const noexcept
 {
-   #if JucePlugin_WantsMidiInput
-    return true;
-   #else
-    return false;
-   #endif
+    auto* filter = linearPhaseFilters.getReadBuffer().get();
+
+    if (filter == nullptr || filter->getNumChannels() != linearPhaseNumChannels
+        || filter->getSampleRate() != designSampleRate.load(std::memory_order_relaxed))
+        return nullptr;
+
+    return filter;
 }
 
-bool SuperFreqAudioProcessor::producesMidi() const
+void SuperFreqAudioProcessor::applyCoefficients(const ChainCoefficients& chainCoefficients)
 {
-   #if JucePlugin_ProducesMidiOutput
-    return true;
-   #else
-    return false;
-   #endif
+    floatChains.applyCoefficients(chainCoefficients);
+    doubleChains.applyCoefficients(chainCoefficients);
+    appliedActiveBands = chainCoefficients.activeBands;
 }
 
-bool SuperFreqAudioProcessor::isMidiEffect() const
+int SuperFreqAudioProcessor::getControllerIndex(const juce::MidiMessage& message) const noexcept
 {
-   #if JucePlugin_IsMidiEffect
-    return true;
-   #else
-    return false;
-   #endif
+    if (! message.isController())
+        return -1;
+
+    const auto band = message.getChannel() - 1;
+    const auto index = message.getControllerNumber() - freqController;
+
+    if (! juce::isPositiveAndBelow(band, maxBands) || ! juce::isPositiveAndBelow(index, numControllers)
+        || controlledParameters[(size_t)band][(size_t)index] == nullptr)
+        return -1;
+
+    return band * numControllers + index;
 }
 
-double SuperFreqAudioProcessor::getTailLengthSeconds() const
+juce::uint32 SuperFreqAudioProcessor::setControllerValue(const juce::MidiMessage& message) noexcept
 {
-    return 0.0;
+    const auto controller = getControllerIndex(message);
+
+    if (controller < 0)
+        return 0;
+
+    const auto band = controller / numControllers;
+    const auto index = controller % numControllers;
+    const auto* parameter = controlledParameters[(size_t)band][(size_t)index];
+
+    // Snapped to the parameter's range, so that nothing moves when the host's value takes over.
+    const auto value = parameter->convertFrom0to1((float)message.getControllerValue() / 127.f);
+
+    chainParameters.bands[(size_t)band].controllerValues[(size_t)index].store(value);
+    pendingControllerValues.fetch_or((juce::uint64)1 << controller);
+
+    return 1u << band;
 }
 
-int SuperFreqAudioProcessor::getNumPrograms()
+void SuperFreqAudioProcessor::setControllerValues(const juce::MidiBuffer& midiMessages) noexcept
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    juce::uint32 bands = 0;
+
+    for (const auto metadata : midiMessages)
+        bands |= setControllerValue(metadata.getMessage());
+
+    // One change for the whole block, as if the parameters had moved once.
+    if (bands != 0)
+        parametersVersion.fetch_add(1, std::memory_order_release);
 }
 
-int SuperFreqAudioProcessor::getCurrentProgram()
+void SuperFreqAudioProcessor::timerCallback()
 {
-    return 0;
+    // The latency of the current mode and oversampling factor, as the parameters move.
+    const auto latency = getLatencyInSamples(getProcessingMode());
+
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+
+    // Host notifications lock and call back into the host, so they happen here rather
+    // than on the audio thread, and only the latest value of each parameter is sent.
+    auto pending = pendingControllerValues.exchange(0);
+
+    for (int controller = 0; pending != 0; ++controller, pending >>= 1)
+    {
+        if ((pending & 1) == 0)
+            continue;
+
+        const auto band = (size_t)(controller / numControllers);
+        const auto index = (size_t)(controller % numControllers);
+
+        auto* parameter = controlledParameters[band][index];
+        auto& controllerValue = chainParameters.bands[band].controllerValues[index];
+        auto value = controllerValue.load();
+
+        if (std::isnan(value))
+            continue;
+
+        parameter->beginChangeGesture();
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        parameter->endChangeGesture();
+
+        // The parameter has the value now, unless the controller has moved on since.
+        controllerValue.compare_exchange_strong(value, std::numeric_limits<float>::quiet_NaN());
+    }
 }
 
-void SuperFreqAudioProcessor::setCurrentProgram (int index)
+void SuperFreqAudioProcessor::clearControllerValues() noexcept
 {
+    for (auto& band : chainParameters.bands)
+        for (auto& controllerValue : band.controllerValues)
+            controllerValue.store(std::numeric_limits<float>::quiet_NaN());
+
+    pendingControllerValues.store(0);
+    parametersVersion.fetch_add(1, std::memory_order_release);
 }
 
-const juce::String SuperFreqAudioProcessor::getProgramName (int index)
+void SuperFreqAudioProcessor::designControlledBands(juce::uint32 bands)
 {
-    return {};
+    // The smoothed path glides to the new values from the version change by itself,
+    // and the parallel form can only be expanded on the design thread.
+    const auto dynamicsOn = static_cast<Band2Dynamics>(band2Dynamics->load()) != Band2Dynamics::Dynamics_Off;
+
+    if (getControlInterval() > 0 || dynamicsOn || glideActive || getProcessingMode() == ProcessingMode::Mode_Parallel)
+        return;
+
+    updateBandsFast(getChainSettings(chainParameters), bands);
+
+    // Until the design thread catches up, its older sets would undo the move.
+    minimumDesignVersion = parametersVersion.load(std::memory_order_acquire);
 }
 
-void SuperFreqAudioProcessor::changeProgramName (int index, const juce::String& newName)
+void SuperFreqAudioProcessor::updateBandsFast(const ChainSettings& chainSettings, juce::uint32 bands)
 {
+    const auto sampleRate = getChainSampleRate();
+
+    makeBandCoefficientsFast(chainSettings, bands, sampleRate, bandCoefficients);
+
+    if (bandCoefficients.activeBands == (appliedActiveBands & bands))
+        updateCoefficients(bandCoefficients);
+    else
+        applyCoefficients(makeChainCoefficientsFast(chainSettings, sampleRate));
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+void SuperFreqAudioProcessor::fadeInBands(juce::uint32 bands)
 {
-    ChainSettings settings;
+    const auto target = getChainSettings(chainParameters);
+    auto start = target;
 
-    settings.band1Freq = apvts.getRawParameterValue("band1 freq")->load();
-    settings.band2Freq = apvts.getRawParameterValue("band2 freq")->load();
-    settings.band2Gain = apvts.getRawParameterValue("band2 gain")->load();
-    settings.band2Q = apvts.getRawParameterValue("band2 q")->load();
-    settings.band3Freq = apvts.getRawParameterValue("band3 freq")->load();
-    settings.band1Slope = apvts.getRawParameterValue("Slope")->load();
-    settings.band3Slope = apvts.getRawParameterValue("Slope")->load();
+    for (int band = 0; band < maxBands; ++band)
+        if ((bands >> band) & 1)
+            start.bands[(size_t)band].gain = 0.f;
 
-    return settings;
+    smoothedSettings = start;
+    chainSmoother.setCurrentAndTargetValue(start);
+    chainSmoother.setTargetValue(target);
+    smoothedParametersVersion = parametersVersion.load(std::memory_order_acquire);
+    samplesUntilControlTick = 0;
+    smoothingActive = true;
+    glideActive = true;
+}
+
+void SuperFreqAudioProcessor::updateCoefficients(const ChainCoefficients& chainCoefficients)
+{
+    floatChains.updateCoefficients(chainCoefficients);
+    doubleChains.updateCoefficients(chainCoefficients);
 }
 
 //==============================================================================
@@ -111,24 +1050,62 @@ void SuperFreqAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
 
-    juce::dsp::ProcessSpec spec;
+    designSampleRate.store(sampleRate);
+    rtInstrumentation.prepare(sampleRate);
+    analyzer.prepare(sampleRate);
+
+    chainSmoother.reset(sampleRate, 0.05);
+    smoothingActive = false;
+    glideActive = false;
+
+    // The detector runs at the host rate, ahead of any oversampling.
+    dynamicBand.prepare(sampleRate);
+    dynamicsActive = false;
+    appliedDynamicGain = 0.f;
+
+    // The sidechain only feeds band2's detector, so the chains are sized for the main bus.
+    const auto numChannels = juce::jmax(1, getMainBusNumInputChannels());
+
+    // Both precisions are prepared, so the "precision" parameter can change during playback.
+    activeOversamplingStages = getOversamplingStages();
+    floatChains.prepare(numChannels, samplesPerBlock, activeOversamplingStages);
+    doubleChains.prepare(numChannels, samplesPerBlock, activeOversamplingStages);
+    doubleChainsActive = false;
 
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
-    spec.sampleRate = sampleRate;
+    // The design thread sizes the worker pool for the double chains, which, with
+    // fewer lanes, have the most groups.
+    numChannelGroups.store((int)InterleavedChains<double>::getNumChannelGroups((size_t)numChannels));
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    // The design thread picks up the new sample rate shortly, but the first
+    // blocks need a design too, and allocating here is fine.
+    const auto chainSettings = getChainSettings(chainParameters);
+    auto chainCoefficients = makeChainCoefficients(chainSettings, sampleRate * (1 << activeOversamplingStages));
+    expandParallelForm(chainCoefficients);
+    applyCoefficients(chainCoefficients);
 
-    auto chainSettings = getChainSettings(apvts);
+    {
+        // The design thread builds the linear-phase filter once the mode is selected,
+        // but if it already is, the first blocks need it. The audio thread isn't
+        // running, so the hand-offs can be taken for it straight away.
+        const juce::ScopedLock sl(linearPhaseLock);
+        linearPhaseNumChannels = numChannels;
+
+        if (chainSettings.processingMode == ProcessingMode::Mode_LinearPhase)
+        {
+            updateLinearPhase(parametersVersion.load(std::memory_order_acquire), sampleRate);
+            linearPhaseFilters.acquire();
+            linearPhaseKernels.acquire();
+        }
+    }
+
+    linearPhaseActive = false;
 
-    auto band2Coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, 
-                                                                            chainSettings.band2Freq, 
-                                                                            chainSettings.band2Q, 
-                                                                            juce::Decibels::decibelsToGain(chainSettings.band2Gain));
-     
-    leftChain.get<ChainPositions::band2>().coefficients = *band2Coefficients;
-    rightChain.get<ChainPositions::band2>().coefficients = *band2Coefficients;
+    silentSamples = 0;
+    chainsIdle = false;
+
+    linearPhaseLatencySamples.store(LinearPhaseFilter::getLatencyInSamples(sampleRate));
+    setLatencySamples(getLatencyInSamples(chainSettings.processingMode));
+    updateTailLength(chainSettings, sampleRate);
 }
 
 void SuperFreqAudioProcessor::releaseResources()
@@ -144,12 +1121,9 @@ bool SuperFreqAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Channels are packed into SIMD lanes in groups, so any channel count works,
+    // from mono up to surround and ambisonic busses.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -163,7 +1137,31 @@ bool SuperFreqAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
 }
 #endif
 
+bool SuperFreqAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 void SuperFreqAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    const RealtimeInstrumentation::ScopedBlock scopedBlock(rtInstrumentation, buffer.getNumSamples());
+
+    analyzer.push(SpectrumAnalyzer::pre, buffer, getMainBusNumInputChannels());
+    processSamples(buffer, midiMessages);
+    analyzer.push(SpectrumAnalyzer::post, buffer, getMainBusNumOutputChannels());
+}
+
+void SuperFreqAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    const RealtimeInstrumentation::ScopedBlock scopedBlock(rtInstrumentation, buffer.getNumSamples());
+
+    analyzer.push(SpectrumAnalyzer::pre, buffer, getMainBusNumInputChannels());
+    processSamples(buffer, midiMessages);
+    analyzer.push(SpectrumAnalyzer::post, buffer, getMainBusNumOutputChannels());
+}
+
+template <typename SampleType>
+void SuperFreqAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -178,26 +1176,130 @@ void SuperFreqAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    auto chainSettings = getChainSettings(apvts);
+    // The sidechain channels follow the main ones, and only band2's detector reads them.
+    juce::dsp::AudioBlock<SampleType> block(buffer);
+    block = block.getSubsetChannelBlock(0, (size_t)getMainBusNumInputChannels());
+
+    auto isSilent = [](juce::dsp::AudioBlock<const SampleType> samples)
+    {
+        const auto range = samples.findMinAndMax();
+        return juce::jmax(-range.getStart(), range.getEnd()) < static_cast<SampleType>(silenceThreshold);
+    };
+
+    // Silence through chains that have rung out stays silence, so they sit out until
+    // the input comes back. Their state has been cleared, which is where it would have
+    // decayed to, so they pick up from the first sample as if they had run throughout.
+    const auto inputSilent = isSilent(block);
+    silentSamples = inputSilent ? juce::jmin(silentSamples + buffer.getNumSamples(), std::numeric_limits<int>::max() / 2) : 0;
+
+    if (chainsIdle && inputSilent)
+    {
+        // Nothing to split, but the controllers still move their parameters, and a
+        // preset recalled during the silence is in place when the input comes back.
+        setControllerValues(midiMessages);
+
+        takeDesignsWhileIdle();
+        return;
+    }
+
+    chainsIdle = false;
+    processMainBus(buffer, block, midiMessages);
+
+    // The tail length only bounds the ring-down, so the output has to agree that it has ended.
+    if (inputSilent && silentSamples >= tailLengthSamples.load(std::memory_order_relaxed) && isSilent(block))
+    {
+        chainsIdle = true;
+
+        floatChains.reset();
+        doubleChains.reset();
+        dynamicBand.reset();
+
+        // The linear-phase filter is cleared when it is next used.
+        linearPhaseActive = false;
+    }
+}
+
+template <typename SampleType>
+void SuperFreqAudioProcessor::processMainBus(juce::AudioBuffer<SampleType>& buffer, juce::dsp::AudioBlock<SampleType> block, const juce::MidiBuffer& midiMessages)
+{
+    if (getProcessingMode() == ProcessingMode::Mode_LinearPhase)
+    {
+        // The kernels are only designed on the design thread, so controllers act at block rate here.
+        setControllerValues(midiMessages);
+
+        smoothingActive = false;
+
+        // Until the design thread has built the filter for this layout and rate, the
+        // output is held silent, as it is while a kernel for a new rate is on its way.
+        linearPhaseFilters.acquire();
+        auto* filter = getLinearPhaseFilter();
+
+        if (filter == nullptr)
+        {
+            block.clear();
+            linearPhaseActive = false;
+            return;
+        }
+
+        // Coming back to linear phase, the delay line holds audio from when it was last used.
+        if (! linearPhaseActive)
+            filter->reset();
+
+        linearPhaseActive = true;
+
+        filter->process(block, linearPhaseKernels);
+        return;
+    }
+
+    linearPhaseActive = false;
+
+    const auto oversamplingStages = getOversamplingStages();
+
+    if (oversamplingStages != activeOversamplingStages)
+    {
+        // The fast design doesn't allocate, so the chains get coefficients for the
+        // new rate straight away.
+        activeOversamplingStages = oversamplingStages;
+
+        floatChains.setOversamplingStages(activeOversamplingStages);
+        doubleChains.setOversamplingStages(activeOversamplingStages);
+
+        applyCoefficients(makeChainCoefficientsFast(getChainSettings(chainParameters), getChainSampleRate()));
+    }
+
+    // Both precisions always have the current coefficients, but the one taking over
+    // has been idle, so its state is stale.
+    const auto useDoubleChains = std::is_same<SampleType, double>::value || usesDoublePrecisionState();
+
+    if (useDoubleChains != doubleChainsActive)
+    {
+        doubleChainsActive = useDoubleChains;
 
-    auto band2Coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-        chainSettings.band2Freq,
-        chainSettings.band2Q,
-        juce::Decibels::decibelsToGain(chainSettings.band2Gain));
+        if (doubleChainsActive)
+            doubleChains.reset();
+        else
+            floatChains.reset();
+    }
 
-    leftChain.get<ChainPositions::band2>().coefficients = *band2Coefficients;
-    rightChain.get<ChainPositions::band2>().coefficients = *band2Coefficients;
+    if (restoredStates.acquire())
+        applyRestoredState(restoredStates.getReadBuffer());
 
-    juce::dsp::AudioBlock<float> block(buffer);
+    // The sidechain drives band2's dynamics when it is selected and the host has
+    // connected it, otherwise the main input does.
+    auto* pool = channelThreads->load() > 0.5f ? &workerPool : nullptr;
+    floatChains.setWorkerPool(pool);
+    doubleChains.setWorkerPool(pool);
 
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    const auto useSidechain = static_cast<Band2Dynamics>(band2Dynamics->load()) == Band2Dynamics::Dynamics_Sidechain
+                              && getBusCount(true) > 1 && getChannelCountOfBus(true, 1) > 0;
 
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    auto detectorBuffer = getBusBuffer(buffer, true, useSidechain ? 1 : 0);
+    const juce::dsp::AudioBlock<const SampleType> detector(detectorBuffer);
 
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+    if (doubleChainsActive)
+        processEvents(doubleChains, block, detector, midiMessages);
+    else
+        processEvents(floatChains, block, detector, midiMessages);
 
     /*
     // This is the place where you'd normally do the guts of your plugin's
@@ -215,6 +1317,222 @@ void SuperFreqAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
     */
 }
 
+template <typename Chains, typename SampleType>
+void SuperFreqAudioProcessor::processEvents(Chains& chains, juce::dsp::AudioBlock<SampleType> block, juce::dsp::AudioBlock<const SampleType> detector,
+                                            const juce::MidiBuffer& midiMessages)
+{
+    const auto numSamples = block.getNumSamples();
+    size_t start = 0;
+    juce::uint32 controlledBands = 0;
+
+    // Runs the chains up to end with the events so far applied at start.
+    auto processUpTo = [&](size_t end)
+    {
+        if (controlledBands != 0)
+        {
+            parametersVersion.fetch_add(1, std::memory_order_release);
+            designControlledBands(controlledBands);
+        }
+
+        controlledBands = 0;
+
+        if (end > start)
+            processChains(chains, block.getSubBlock(start, end - start), detector.getSubBlock(start, end - start));
+
+        start = end;
+    };
+
+    for (const auto metadata : midiMessages)
+    {
+        const auto message = metadata.getMessage();
+
+        if (getControllerIndex(message) < 0)
+            continue;
+
+        // A dense stream of events costs at most one split, and one design, per minEventSpacing samples.
+        const auto position = (size_t)juce::jlimit(0, (int)numSamples, metadata.samplePosition);
+
+        if (position >= start + (size_t)minEventSpacing)
+            processUpTo(position);
+
+        controlledBands |= setControllerValue(message);
+    }
+
+    processUpTo(numSamples);
+}
+
+template <typename Chains, typename SampleType>
+void SuperFreqAudioProcessor::processChains(Chains& chains, juce::dsp::AudioBlock<SampleType> block, juce::dsp::AudioBlock<const SampleType> detector)
+{
+    const auto controlInterval = getControlInterval();
+
+    const auto dynamicsOn = static_cast<Band2Dynamics>(band2Dynamics->load()) != Band2Dynamics::Dynamics_Off;
+
+    // band2's dynamics need a control grid even when the rest of the chain would update at block rate,
+    // and so does a glide to a restored state or of bands fading in.
+    if (controlInterval > 0 || dynamicsOn || glideActive)
+    {
+        processSmoothed(chains, block, detector, controlInterval > 0 ? controlInterval : dynamicsControlInterval);
+
+        if (glideActive && ! chainSmoother.isSmoothing())
+        {
+            glideActive = false;
+
+            // Back at block rate, the glide ends on the exact design of where it was heading, if there is one yet;
+            // otherwise the design thread's next set takes over.
+            if (controlInterval == 0 && ! dynamicsOn)
+            {
+                const auto version = parametersVersion.load(std::memory_order_acquire);
+                auto isCurrent = [&](const ChainCoefficients& chainCoefficients)
+                {
+                    return chainCoefficients.parametersVersion == version && chainCoefficients.sampleRate == getChainSampleRate();
+                };
+
+                coefficientSets.acquire();
+
+                if (isCurrent(coefficientSets.getReadBuffer()))
+                    applyCoefficients(coefficientSets.getReadBuffer());
+                else if (isCurrent(restoredStates.getReadBuffer().coefficients))
+                    applyCoefficients(restoredStates.getReadBuffer().coefficients);
+
+                smoothingActive = false;
+            }
+        }
+
+        return;
+    }
+
+    smoothingActive = false;
+
+    // A set designed for the previous sample rate can still be in flight right
+    // after prepareToPlay, and one designed before a restored state right after
+    // that; the design thread follows up with a fresh one.
+    if (coefficientSets.acquire())
+    {
+        const auto& chainCoefficients = coefficientSets.getReadBuffer();
+
+        if (isUsableDesign(chainCoefficients))
+        {
+            // Bands joining the chain start from silent state, so rather than switching
+            // them in mid-signal, a bell or shelf fades in from 0 dB.
+            const auto joiningBands = chainCoefficients.activeBands & ~appliedActiveBands;
+            const auto target = getChainSettings(chainParameters);
+            juce::uint32 fadingBands = 0;
+
+            for (int band = 0; band < maxBands; ++band)
+                if (((joiningBands >> band) & 1) != 0 && target.bands[(size_t)band].hasGain())
+                    fadingBands |= 1u << band;
+
+            if (fadingBands != 0)
+            {
+                fadeInBands(fadingBands);
+                processSmoothed(chains, block, detector, dynamicsControlInterval);
+                return;
+            }
+
+            applyCoefficients(chainCoefficients);
+        }
+    }
+
+    chains.process(block);
+}
+
+template <typename Chains, typename SampleType>
+void SuperFreqAudioProcessor::processSmoothed(Chains& chains, juce::dsp::AudioBlock<SampleType> block, juce::dsp::AudioBlock<const SampleType> detector, int controlInterval)
+{
+    const auto version = parametersVersion.load(std::memory_order_acquire);
+    auto needsDesign = false;
+
+    if (! smoothingActive)
+    {
+        // Start from where the block-rate path left off rather than sweeping in from the last ramp.
+        smoothedSettings = getChainSettings(chainParameters);
+        chainSmoother.setCurrentAndTargetValue(smoothedSettings);
+        smoothedParametersVersion = version;
+        samplesUntilControlTick = 0;
+        smoothingActive = true;
+        needsDesign = true;
+    }
+    else if (version != smoothedParametersVersion)
+    {
+        chainSmoother.setTargetValue(getChainSettings(chainParameters));
+        smoothedParametersVersion = version;
+        needsDesign = true;
+    }
+
+    const auto dynamicsOn = static_cast<Band2Dynamics>(band2Dynamics->load()) != Band2Dynamics::Dynamics_Off;
+
+    if (dynamicsOn != dynamicsActive)
+    {
+        // The detector starts from silence rather than from whatever it heard last time,
+        // and switching off needs a design with the static gain.
+        dynamicsActive = dynamicsOn;
+        dynamicBand.reset();
+        appliedDynamicGain = 0.f;
+        needsDesign = true;
+    }
+
+    const auto sampleRate = getChainSampleRate();
+    const auto numSamples = block.getNumSamples();
+
+    for (size_t start = 0; start < numSamples;)
+    {
+        if (samplesUntilControlTick == 0)
+        {
+            // The grid runs on across blocks, so the update rate doesn't depend on the host block size.
+            // The moving bands are taken before the step, which may be the one that ends their ramps.
+            const auto movingBands = chainSmoother.getMovingBands();
+
+            if (needsDesign || movingBands != 0)
+                smoothedSettings = chainSmoother.skip(controlInterval);
+
+            auto chainSettings = smoothedSettings;
+            auto bandsToDesign = movingBands;
+
+            if (dynamicsActive)
+            {
+                const auto& bell = chainSettings.bands[bellBand];
+
+                dynamicBand.setParameters(bell.freq, bell.q, chainSettings.band2Attack, chainSettings.band2Release);
+                const auto dynamicGain = dynamicBand.getGainDecibels(chainSettings.band2Threshold, chainSettings.band2Ratio);
+
+                // Gain moves too small to hear don't cost a redesign.
+                if (std::abs(dynamicGain - appliedDynamicGain) > 0.01f)
+                    bandsToDesign |= 1u << bellBand;
+
+                if (needsDesign || ((bandsToDesign >> bellBand) & 1) != 0)
+                    appliedDynamicGain = dynamicGain;
+
+                chainSettings.bands[bellBand].gain += appliedDynamicGain;
+            }
+
+            // Only structural changes need the whole chain; while the ramps and the dynamics
+            // run, just the bands they move are redesigned, in place.
+            if (needsDesign)
+                applyCoefficients(makeChainCoefficientsFast(chainSettings, sampleRate));
+            else if (bandsToDesign != 0)
+                updateBandsFast(chainSettings, bandsToDesign);
+
+            needsDesign = false;
+            samplesUntilControlTick = controlInterval;
+        }
+
+        // Once the ramps have settled nothing changes at the grid points, so the rest of the block goes
+        // in one piece, unless the dynamics need the grid.
+        const auto available = chainSmoother.isSmoothing() || dynamicsActive ? (size_t)samplesUntilControlTick : numSamples - start;
+        const auto length = juce::jmin(available, numSamples - start);
+
+        // The detector hears each piece before the chains change it, which matters when it is the main input.
+        if (dynamicsActive)
+            dynamicBand.analyse(detector.getSubBlock(start, length));
+
+        chains.process(block.getSubBlock(start, length));
+
+        start += length;
+        samplesUntilControlTick = (int)(((size_t)samplesUntilControlTick + (size_t)controlInterval - length % (size_t)controlInterval) % (size_t)controlInterval);
+    }
+}
+
 //==============================================================================
 bool SuperFreqAudioProcessor::hasEditor() const
 {
@@ -223,25 +1541,138 @@ bool SuperFreqAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* SuperFreqAudioProcessor::createEditor()
 {
-    //return new SuperFreqAudioProcessorEditor (*this);
-    return new juce::GenericAudioProcessorEditor(*this);
+    return new SuperFreqAudioProcessorEditor (*this);
 }
 
 //==============================================================================
 void SuperFreqAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    // Read straight from the parameters, so it doesn't depend on the APVTS timer
+    // having synced its ValueTree, which matters when there is no message loop.
+    binaryState.write(destData);
 }
 
 void SuperFreqAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    const auto previousSettings = getChainSettings(chainParameters);
+
+    // The recalled values replace whatever the controllers had set and not yet passed on.
+    clearControllerValues();
+
+    if (BinaryState::canRead(data, sizeInBytes))
+    {
+        binaryState.read(data, sizeInBytes);
+    }
+    else
+    {
+        // Sessions saved before the binary format hold the APVTS ValueTree.
+        auto tree = juce::ValueTree::readFromData(data, (size_t)sizeInBytes);
+
+        if (! tree.isValid())
+            return;
+
+        apvts.replaceState(tree);
+    }
+
+    publishRestoredState(previousSettings);
+}
+
+void SuperFreqAudioProcessor::publishRestoredState(const ChainSettings& previousSettings)
+{
+    // Before prepareToPlay there is no rate to design for, and prepareToPlay designs anyway.
+    const auto sampleRate = designSampleRate.load();
+
+    if (sampleRate <= 0.0)
+        return;
+
+    auto& restored = restoredStates.getWriteBuffer();
+
+    restored.parametersVersion = parametersVersion.load(std::memory_order_acquire);
+    restored.previousSettings = previousSettings;
+    restored.settings = getChainSettings(chainParameters);
+    restored.coefficients = makeChainCoefficients(restored.settings, sampleRate * (1 << getOversamplingStages()));
+    restored.coefficients.parametersVersion = restored.parametersVersion;
+    expandParallelForm(restored.coefficients);
+
+    restoredStates.publish();
+}
+
+void SuperFreqAudioProcessor::applyRestoredState(const RestoredState& restored)
+{
+    // Anything that moved since, or a new rate, makes it stale, and the usual paths take over.
+    if (restored.parametersVersion != parametersVersion.load(std::memory_order_acquire)
+        || restored.coefficients.sampleRate != getChainSampleRate())
+        return;
+
+    minimumDesignVersion = restored.parametersVersion;
+
+    if (isTransportPlaying() && ! chainsIdle)
+    {
+        // Jumping to new coefficients mid-playback would click, so the smoother
+        // glides there, from wherever the chain is now.
+        if (! smoothingActive)
+        {
+            smoothedSettings = restored.previousSettings;
+            chainSmoother.setCurrentAndTargetValue(smoothedSettings);
+            samplesUntilControlTick = 0;
+            smoothingActive = true;
+        }
+
+        chainSmoother.setTargetValue(restored.settings);
+        smoothedParametersVersion = restored.parametersVersion;
+        glideActive = true;
+        return;
+    }
+
+    // With the transport stopped, as when a session loads, or nothing sounding, the
+    // chains start afresh on the finished design, and nothing is designed on this thread.
+    applyCoefficients(restored.coefficients);
+    floatChains.reset();
+    doubleChains.reset();
+
+    smoothedSettings = restored.settings;
+    chainSmoother.setCurrentAndTargetValue(smoothedSettings);
+    smoothedParametersVersion = restored.parametersVersion;
+    samplesUntilControlTick = 0;
+    glideActive = false;
+
+    // The design has band2 at its static gain, which is where the dynamics start from.
+    dynamicsActive = static_cast<Band2Dynamics>(band2Dynamics->load()) != Band2Dynamics::Dynamics_Off;
+    dynamicBand.reset();
+    appliedDynamicGain = 0.f;
+
+    // The smoothed path would otherwise start by redesigning what it has just been given.
+    smoothingActive = getControlInterval() > 0 || dynamicsActive;
+}
+
+bool SuperFreqAudioProcessor::isUsableDesign(const ChainCoefficients& chainCoefficients) const noexcept
+{
+    return chainCoefficients.sampleRate == getChainSampleRate()
+           && (juce::int32)(chainCoefficients.parametersVersion - minimumDesignVersion) >= 0;
+}
+
+void SuperFreqAudioProcessor::takeDesignsWhileIdle()
+{
+    if (restoredStates.acquire())
+        applyRestoredState(restoredStates.getReadBuffer());
+
+    // Only the block-rate path takes the design thread's sets; the smoothed one designs
+    // for itself when it wakes up. Bands joining the chain have nothing to fade in over.
+    const auto dynamicsOn = static_cast<Band2Dynamics>(band2Dynamics->load()) != Band2Dynamics::Dynamics_Off;
+
+    if (getControlInterval() == 0 && ! dynamicsOn && ! glideActive && coefficientSets.acquire())
+        if (isUsableDesign(coefficientSets.getReadBuffer()))
+            applyCoefficients(coefficientSets.getReadBuffer());
 }
 
+bool SuperFreqAudioProcessor::isTransportPlaying() const
+{
+    if (auto* playHead = getPlayHead())
+        if (const auto position = playHead->getPosition())
+            return position->getIsPlaying();
 
+    return false;
+}
 
 juce::AudioProcessorValueTreeState::ParameterLayout
     SuperFreqAudioProcessor::createParameterLayout()
@@ -282,7 +1713,81 @@ juce::AudioProcessorValueTreeState::ParameterLayout
         stringArray.add(str);
     }
 
-    layout.add(std::make_unique<juce::AudioParameterChoice>("Slope", "Slope", stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("band1 slope", "band1 slope", stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("band3 slope", "band3 slope", stringArray, 0));
+
+    // band2 as a dynamic bell, driven by the main input or the sidechain. The
+    // linear-phase mode has fixed kernels, so it keeps the static gain.
+    layout.add(std::make_unique<juce::AudioParameterChoice>("band2 dynamics", "band2 dynamics",
+                                                            juce::StringArray{ "Off", "Input", "Sidechain" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "band2 threshold",
+                                                            "band2 threshold",
+                                                            juce::NormalisableRange<float>(-60.f, 0.f, 0.5f, 1.f),
+                                                            -24.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "band2 ratio",
+                                                            "band2 ratio",
+                                                            juce::NormalisableRange<float>(1.f, 20.f, 0.1f, 0.4f),
+                                                            2.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "band2 attack",
+                                                            "band2 attack",
+                                                            juce::NormalisableRange<float>(0.1f, 200.f, 0.1f, 0.4f),
+                                                            10.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>( "band2 release",
+                                                            "band2 release",
+                                                            juce::NormalisableRange<float>(5.f, 2000.f, 1.f, 0.4f),
+                                                            150.f));
+
+    // The optional bands, off until they are given a type. Their cuts are 12 dB/Oct.
+    for (int band = numFixedBands; band < maxBands; ++band)
+    {
+        const auto typeID = getBandParameterID(band, "type");
+        const auto freqID = getBandParameterID(band, "freq");
+        const auto gainID = getBandParameterID(band, "gain");
+        const auto qID = getBandParameterID(band, "q");
+
+        // Spread over 40 Hz to 16 kHz, so switching a few on doesn't stack them up.
+        const auto position = (float)(band - numFixedBands) / (float)(maxBands - numFixedBands - 1);
+        const auto defaultFreq = (float)juce::roundToInt(40.f * std::pow(400.f, position));
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(typeID, typeID,
+                                                                juce::StringArray{ "Off", "Bell", "Low shelf", "High shelf", "Low cut", "High cut" }, 0));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>( freqID,
+                                                                freqID,
+                                                                juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.5f),
+                                                                defaultFreq));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>( gainID,
+                                                                gainID,
+                                                                juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+                                                                0.f));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>( qID,
+                                                                qID,
+                                                                juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
+                                                                1.f));
+    }
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("control rate", "control rate",
+                                                            juce::StringArray{ "Block", "1 sample", "8 samples", "16 samples", "32 samples", "64 samples" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("processing mode", "processing mode",
+                                                            juce::StringArray{ "Biquad", "SVF", "Linear phase", "Parallel" }, 0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("oversampling", "oversampling",
+                                                            juce::StringArray{ "Off", "2x", "4x" }, 0));
+
+    // Only affects float buffers; a double-precision host always gets double state.
+    layout.add(std::make_unique<juce::AudioParameterChoice>("precision", "precision",
+                                                            juce::StringArray{ "Float", "Double" }, 0));
+
+    // Shares the channel groups of wide busses out to worker threads. The linear-phase mode stays on one thread.
+    layout.add(std::make_unique<juce::AudioParameterChoice>("channel threads", "channel threads",
+                                                            juce::StringArray{ "Off", "On" }, 0));
 
     return layout;
 }
@@ -293,4 +1798,3 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 {
     return new SuperFreqAudioProcessor();
 }
-Builds\VisualStudio2022
\ No newline at end of file
@@ -9,21 +9,332 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "CascadeFilter.h"
+#include "FastCoefficientMath.h"
+#include "SvfSection.h"
+#include "LinearPhaseFilter.h"
+#include "ParallelFilter.h"
+#include "HalfBandOversampler.h"
+#include "DynamicBand.h"
+#include "TripleBuffer.h"
+#include "BinaryState.h"
+#include "ChannelWorkerPool.h"
+#include "RealtimeInstrumentation.h"
+#include "SpectrumAnalyzer.h"
+
+enum Slope
+{
+    Slope_12,
+    Slope_24,
+    Slope_36,
+    Slope_48
+};
+
+enum ProcessingMode
+{
+    Mode_Biquad,
+    Mode_Svf,
+    Mode_LinearPhase,
+    Mode_Parallel
+};
+
+// What drives band2's gain, on top of its static setting.
+enum Band2Dynamics
+{
+    Dynamics_Off,
+    Dynamics_Input,
+    Dynamics_Sidechain
+};
+
+// In the order of the "type" parameter of the optional bands.
+enum BandType
+{
+    Band_Off,
+    Band_Bell,
+    Band_LowShelf,
+    Band_HighShelf,
+    Band_LowCut,
+    Band_HighCut
+};
+
+struct BandSettings
+{
+    BandType type{ BandType::Band_Off };
+    float freq{ 1000.f }, gain{ 0 }, q{ 1.f };
+
+    // Only the cuts use the slope; each 12 dB/Oct of it is one Butterworth section.
+    Slope slope{ Slope::Slope_12 };
+
+    // Bells and shelves closer to 0 dB than this are left out of the chain.
+    static constexpr float identityGainDecibels = 0.01f;
+
+    // Bells and shelves, which are a pass-through at 0 dB.
+    bool hasGain() const noexcept;
+
+    // Off, or a bell or shelf within identityGainDecibels of 0 dB: no sections to run.
+    bool isIdentity() const noexcept;
+
+    int getNumSections() const noexcept;
+};
+
+static constexpr int maxBands = 16;
+
+// Indices into ChainSettings::bands of the original three bands, "band1" to "band3",
+// whose types are fixed. The rest are optional and start out off.
+enum FixedBand
+{
+    lowCutBand,
+    bellBand,
+    highCutBand,
+    numFixedBands
+};
 
 struct ChainSettings
 {
-    float band2Freq{ 0 }, band2Gain{ 0 }, band2Q{ 1.f };
-    float band1Freq{ 0 }, band3Freq{ 0 };
-    int band1Slope{ 0 }, band3Slope{ 0 };
+    std::array<BandSettings, maxBands> bands;
+    ProcessingMode processingMode{ ProcessingMode::Mode_Biquad };
+
+    // band2 as a dynamic bell; the times are in milliseconds.
+    Band2Dynamics band2Dynamics{ Band2Dynamics::Dynamics_Off };
+    float band2Threshold{ 0 }, band2Ratio{ 1.f }, band2Attack{ 10.f }, band2Release{ 150.f };
+};
+
+/** "band<n> <name>", the ID of a band parameter, counting bands from 1. */
+juce::String getBandParameterID(int band, const juce::String& name);
+
+/** The raw values of every parameter ChainSettings is made from, looked up once
+    by ID so that reading them doesn't search or allocate on any thread.
+*/
+struct ChainParameters
+{
+    explicit ChainParameters(juce::AudioProcessorValueTreeState& apvts);
+
+    // Null where a band has no such parameter: the fixed bands have no type, and
+    // only the cuts among them have a slope.
+    struct Band
+    {
+        std::atomic<float>* type = nullptr;
+        std::atomic<float>* freq = nullptr;
+        std::atomic<float>* gain = nullptr;
+        std::atomic<float>* q = nullptr;
+        std::atomic<float>* slope = nullptr;
+
+        // Freq, gain and q as MIDI controllers have set them on the audio thread, read
+        // in place of the parameters' own values until the message thread has passed
+        // them on to the host; NaN where there is none.
+        std::array<std::atomic<float>, 3> controllerValues;
+    };
+
+    std::array<Band, maxBands> bands;
+
+    std::atomic<float>* processingMode = nullptr;
+    std::atomic<float>* band2Dynamics = nullptr;
+    std::atomic<float>* band2Threshold = nullptr;
+    std::atomic<float>* band2Ratio = nullptr;
+    std::atomic<float>* band2Attack = nullptr;
+    std::atomic<float>* band2Release = nullptr;
+};
+
+ChainSettings getChainSettings(const ChainParameters& chainParameters);
+
+//==============================================================================
+/** Ramps the continuous band parameters towards their targets. Slopes can't be
+    interpolated, so they switch as soon as a new target is set.
+*/
+class ChainSmoother
+{
+public:
+    void reset(double sampleRate, double rampLengthInSeconds);
+
+    void setCurrentAndTargetValue(const ChainSettings& chainSettings);
+    void setTargetValue(const ChainSettings& chainSettings);
+
+    bool isSmoothing() const noexcept { return getMovingBands() != 0; }
+
+    /** Bit n is set while band n is on and one of its ramps is still running. */
+    juce::uint32 getMovingBands() const noexcept;
+
+    /** Advances every ramp by numSamples and returns where they end up. */
+    ChainSettings skip(int numSamples) noexcept;
 
-    ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+private:
+    ChainSettings target;
 
+    std::array<juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>, maxBands> freq, q;
+    std::array<juce::SmoothedValue<float>, maxBands> gain;
 };
 
+//==============================================================================
+// Each 12 dB/Oct of slope is one Butterworth section.
+static constexpr int maxCutStages = Slope::Slope_48 + 1;
+
+// Every band owns maxCutStages state slots, whatever its type, so its filter
+// state stays put when the bands before it change.
+static constexpr int maxSections = maxBands * maxCutStages;
+
+static_assert(maxSections <= ParallelForm::maxSections, "The parallel form needs a section per cascade section");
+static_assert(maxBands <= 32, "ChainCoefficients::activeBands has a bit per band");
+
+/** Everything the audio thread needs to set up the chain, designed for one sample
+    rate and one processing mode: the sections of the bands that are on, in
+    processing order, with the state slot of each. Only the coefficients of that
+    mode are filled in. The linear-phase and parallel modes get the biquads, whose
+    response they copy; the parallel form itself is only expanded by the design
+    thread, so until it has been, the cascade stands in. Designs are kept in
+    double; the float chains round them when they are applied.
+*/
+struct ChainCoefficients
+{
+    double sampleRate{ 0.0 };
+    ProcessingMode mode{ ProcessingMode::Mode_Biquad };
+
+    // The processor's parametersVersion at the time of the design, where it is known.
+    juce::uint32 parametersVersion{ 0 };
+
+    // Bit n is set if band n has sections in the design.
+    juce::uint32 activeBands{ 0 };
+
+    int numSections{ 0 };
+    std::array<juce::uint8, maxSections> slots;
+    std::array<BiquadCoefficients<double>, maxSections> sections;
+    std::array<SvfCoefficients<double>, maxSections> svfSections;
+
+    ParallelForm parallel;
+};
+
+/** Designs the whole chain. This doesn't allocate, so the smoothed mode can call it
+    on the audio thread, but it costs a few libm calls per section, so the block-rate
+    mode leaves it to the design thread.
+*/
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate);
+
+/** The same design built from FastCoefficientMath's approximations, with every
+    section of the chain designed in one SIMD batch. Cheap enough to run at audio rate.
+*/
+ChainCoefficients makeChainCoefficientsFast(const ChainSettings& chainSettings, double sampleRate) noexcept;
+
+/** Only the given bands of makeChainCoefficientsFast(), written into an existing set
+    for updateCoefficients(), so that bands moving at audio rate are redesigned in
+    place. Nothing but the mode, the band mask and those bands' sections is touched.
+*/
+void makeBandCoefficientsFast(const ChainSettings& chainSettings, juce::uint32 bands, double sampleRate,
+                              ChainCoefficients& chainCoefficients) noexcept;
+
 //==============================================================================
 /**
+    The biquad, SVF and parallel chains of every channel group, at one precision.
+
+    Channels are interleaved into the lanes of SIMDRegister<NumericType>, so a
+    group holds four float channels but only two double ones (SSE/NEON).
+    The block's own precision may differ: the interleaving pass converts, so a
+    float bus can run on double-precision state at no extra cost. The parallel
+    form puts a channel's sections in the lanes instead, which keeps them busy
+    on mono and stereo busses.
 */
-class SuperFreqAudioProcessor  : public juce::AudioProcessor
+template <typename NumericType>
+class InterleavedChains
+{
+public:
+    void prepare(int numChannels, int samplesPerBlock, int oversamplingStages);
+
+    /** Clears the filter and oversampling state. */
+    void reset() noexcept;
+
+    /** 0 (off), 1 (2x) or 2 (4x). Resets the state, which belongs to the old rate. */
+    void setOversamplingStages(int newOversamplingStages) noexcept;
+
+    // Copies a finished design into every chain of its mode, switching engines if the
+    // mode changed. Allocation-free, so it is safe on the audio thread.
+    void applyCoefficients(const ChainCoefficients& chainCoefficients) noexcept;
+
+    // Copies the sections of a partial design, such as one band's, for the active mode,
+    // leaving the other bands alone. Sections of bands that are off are ignored.
+    void updateCoefficients(const ChainCoefficients& chainCoefficients) noexcept;
+
+    // Processes the block in pieces, in any size the prepared scratch buffer allows.
+    template <typename SampleType>
+    void process(juce::dsp::AudioBlock<SampleType> block) noexcept;
+
+    // Lets process() share the channel groups out to the pool's workers, when a
+    // piece holds enough work to be worth it; null processes them serially.
+    void setWorkerPool(ChannelWorkerPool* newWorkerPool) noexcept { workerPool = newWorkerPool; }
+
+    static size_t getNumChannelGroups(size_t numChannels) { return (numChannels + registerSize - 1) / registerSize; }
+
+private:
+    using SIMDType = juce::dsp::SIMDRegister<NumericType>;
+    static constexpr auto registerSize = SIMDType::size();
+
+    // Runs each group of up to registerSize channels through its own chain, one channel per SIMD lane.
+    template <typename SampleType>
+    void processInterleaved(juce::dsp::AudioBlock<SampleType> block) noexcept;
+
+    // One group's share of processInterleaved(). Groups share nothing they write to,
+    // so they can run on different threads.
+    template <typename SampleType>
+    void processGroup(size_t group, juce::dsp::AudioBlock<SampleType> block) noexcept;
+
+    // Sample-sections of filtering each group needs before handing groups to other
+    // threads pays for the handoff, about a few microseconds of work.
+    static constexpr size_t minWorkPerGroup = 4096;
+    ChannelWorkerPool* workerPool = nullptr;
+
+    // Every channel shares the same coefficients, so the filters run on whole
+    // registers and each section is evaluated once per sample for all channels.
+    // Each cascade holds one coefficient set and one chain of state per group of
+    // registerSize channels, so a 16 channel bus costs four (SSE/NEON) or two
+    // (AVX2) float chains rather than sixteen.
+    SectionCascade<SIMDType, maxSections> biquads;
+
+    // The same bands built from TPT state-variable sections.
+    SectionCascade<SIMDType, maxSections, SvfSection<NumericType>> svfs;
+
+    // The biquads' partial-fraction expansion, with a channel's sections across the lanes.
+    ParallelFilter<NumericType> parallel;
+    size_t numChannelGroups{ 0 };
+
+    // The engine of the last applied design; only its chains are processed.
+    ProcessingMode activeMode{ ProcessingMode::Mode_Biquad };
+
+    // The engine that runs a design: the biquads stand in for a parallel form
+    // that hasn't been expanded, or isn't accurate enough at this precision.
+    static ProcessingMode getEngine(const ChainCoefficients& chainCoefficients) noexcept;
+
+    // Sections in the active engine; with none and no oversampling, processing is a pass-through.
+    int getNumActiveSections() const noexcept;
+
+    // One per channel group, resampling all of its lanes at once. The chains run
+    // at the oversampled rate, which keeps the band2 bell from cramping near Nyquist.
+    std::vector<HalfBandOversampler<SIMDType>> oversamplers;
+    int oversamplingStages{ 0 };
+
+    // Channel-interleaved copy of the block, one SIMD channel per group, that the chains process in place.
+    juce::HeapBlock<char> interleavedData;
+    juce::dsp::AudioBlock<SIMDType> interleaved;
+};
+
+//==============================================================================
+/** A low-priority thread, shared by every instance, that runs the coefficient design. */
+struct CoefficientDesignThread  : public juce::TimeSliceThread
+{
+    CoefficientDesignThread() : juce::TimeSliceThread("SuperFreq Coefficient Design")
+    {
+        startThread(juce::Thread::Priority::low);
+    }
+
+    ~CoefficientDesignThread() override
+    {
+        stopThread(2000);
+    }
+};
+
+//==============================================================================
+/**
+*/
+class SuperFreqAudioProcessor  : public juce::AudioProcessor,
+                                 private juce::AudioProcessorValueTreeState::Listener,
+                                 private juce::TimeSliceClient,
+                                 private juce::Timer
 {
 public:
     //==============================================================================
@@ -39,6 +350,9 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -63,25 +377,279 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    /** Audio-thread counters and block timings, for the editor. Only counts anything
+        when built with SUPERFREQ_RT_INSTRUMENTATION.
+    */
+    const RealtimeInstrumentation& getRealtimeInstrumentation() const noexcept { return rtInstrumentation; }
+
+    /** The pre / post analyzer the editor starts and stops. */
+    SpectrumAnalyzer& getAnalyzer() noexcept { return analyzer; }
+
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts{ *this, nullptr,
         "Parameters", createParameterLayout() };
 
-private: 
-    using Filter = juce::dsp::IIR::Filter<float>;
+    /** What getChainSettings() reads, for anything that designs the chain outside the processor. */
+    const ChainParameters& getChainParameters() const noexcept { return chainParameters; }
 
-    using CutFilter = juce::dsp::ProcessorChain < Filter, Filter, Filter, Filter >;
+    /** The rate the chains are designed for: the host's times the oversampling factor
+        the parameter asks for, or 0 before prepareToPlay. Safe to call from any thread.
+    */
+    double getDesignSampleRate() const noexcept;
 
-    using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
-
-    MonoChain leftChain, rightChain;
+private: 
+    ChainParameters chainParameters{ apvts };
+    BinaryState binaryState{ getParameters() };
 
-    enum ChainPositions
+    /** A state restored by setStateInformation(), with the chain already designed
+        for it on the thread that restored it.
+    */
+    struct RestoredState
     {
-        band1,
-        band2,
-        band3
+        juce::uint32 parametersVersion{ 0 };
+        ChainSettings previousSettings, settings;
+        ChainCoefficients coefficients;
     };
+
+    // Designs the restored parameters and hands them to the audio thread.
+    void publishRestoredState(const ChainSettings& previousSettings);
+
+    // Audio thread: takes over a restored state, gliding to it if the transport is
+    // running and the chains aren't sitting out silence.
+    void applyRestoredState(const RestoredState& restored);
+
+    // Audio thread: whether a design from the design thread is for the chains' rate and
+    // no older than the last one the audio thread made itself.
+    bool isUsableDesign(const ChainCoefficients& chainCoefficients) const noexcept;
+
+    // Audio thread, while the chains sit out silence: applies whatever designs and
+    // restored states have arrived, so the chains wake up on them.
+    void takeDesignsWhileIdle();
+
+    bool isTransportPlaying() const;
+
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+
+    // Runs on the design thread: redesigns and publishes the chain once parametersVersion has moved.
+    int useTimeSlice() override;
+
+    // Applies a design to both precisions, so either can take over at any time.
+    void applyCoefficients(const ChainCoefficients& chainCoefficients);
+
+    // The band parameter a MIDI controller event is mapped to, as band * numControllers
+    // plus its index in controlledParameters, or -1. The event's channel is the band's,
+    // counting from 1.
+    int getControllerIndex(const juce::MidiMessage& message) const noexcept;
+
+    // Audio thread: stores the value of an event mapped to a band parameter where the
+    // chains read it, and returns the bit of the band it moves, or 0. Nothing is
+    // designed until parametersVersion is bumped.
+    juce::uint32 setControllerValue(const juce::MidiMessage& message) noexcept;
+
+    // Audio thread: applies a block's controller events all at once, for the paths that
+    // don't split the block at them, so only the last value of each parameter counts.
+    void setControllerValues(const juce::MidiBuffer& midiMessages) noexcept;
+
+    // Message thread: passes the controller values on to the host, each in a gesture
+    // of its own, and hands them back to the parameters.
+    void timerCallback() override;
+
+    // Drops any controller values not yet passed on, as a recalled state replaces them.
+    void clearControllerValues() noexcept;
+
+    // Audio thread: redesigns the given bands for the block-rate path, straight away,
+    // after controller events have moved them.
+    void designControlledBands(juce::uint32 bands);
+
+    // Audio thread: redesigns just the given bands in place, or the whole chain if one
+    // of them joins or leaves it.
+    void updateBandsFast(const ChainSettings& chainSettings, juce::uint32 bands);
+
+    // Audio thread: glides the chain to the current parameters from a start where the
+    // given bands are at 0 dB, so that bands joining the chain fade in.
+    void fadeInBands(juce::uint32 bands);
+    void updateCoefficients(const ChainCoefficients& chainCoefficients);
+
+    // The body of both processBlock overloads.
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midiMessages);
+
+    // Runs the main bus through the linear-phase filter or the chains, unless they are idle.
+    template <typename SampleType>
+    void processMainBus(juce::AudioBuffer<SampleType>& buffer, juce::dsp::AudioBlock<SampleType> block, const juce::MidiBuffer& midiMessages);
+
+    // Splits the block at the MIDI controller events mapped to band parameters and
+    // applies each at its sample, then runs the pieces through processChains().
+    // Events closer than minEventSpacing to the last split share it.
+    template <typename Chains, typename SampleType>
+    void processEvents(Chains& chains, juce::dsp::AudioBlock<SampleType> block, juce::dsp::AudioBlock<const SampleType> detector,
+                       const juce::MidiBuffer& midiMessages);
+
+    // Runs the chains of one precision, with block-rate or smoothed coefficient updates.
+    // The detector feeds band2's dynamics, if they are on.
+    template <typename Chains, typename SampleType>
+    void processChains(Chains& chains, juce::dsp::AudioBlock<SampleType> block, juce::dsp::AudioBlock<const SampleType> detector);
+
+    // Splits the block on a fixed control-rate grid and, at each grid point, redesigns
+    // the bands whose smoothed parameters are still moving, in place.
+    // With band2's dynamics on, every grid point also redesigns band2 for the detector's level.
+    template <typename Chains, typename SampleType>
+    void processSmoothed(Chains& chains, juce::dsp::AudioBlock<SampleType> block, juce::dsp::AudioBlock<const SampleType> detector, int controlInterval);
+
+    ProcessingMode getProcessingMode() const noexcept;
+
+    // Whether float buffers run through the double-precision chains.
+    bool usesDoublePrecisionState() const noexcept;
+
+    // Half-band stages of the "oversampling" parameter: 0 (off), 1 (2x) or 2 (4x).
+    int getOversamplingStages() const noexcept;
+
+    // The rate the chains run at on the audio thread.
+    double getChainSampleRate() const noexcept { return designSampleRate.load(std::memory_order_relaxed) * (1 << activeOversamplingStages); }
+
+    // The latency of the linear-phase mode while it is selected, otherwise that of
+    // the oversampling filters, if any.
+    int getLatencyInSamples(ProcessingMode mode) const noexcept;
+
+    // Works out how long the output rings on after the input stops, from the poles of
+    // the bands that are on, for the host and for the silence detection.
+    void updateTailLength(const ChainSettings& chainSettings, double sampleRate);
+
+    // Writer side of the linear-phase hand-offs, called with linearPhaseLock held: builds
+    // the convolver for the prepared layout and rate if it hasn't been yet, and redesigns
+    // the kernel once the parameters have moved. Allocates, so it runs on the design
+    // thread, or in prepareToPlay while the mode is selected.
+    void updateLinearPhase(juce::uint32 version, double sampleRate);
+
+    // Audio thread: the convolver, if one has been built for the current layout and rate.
+    LinearPhaseFilter* getLinearPhaseFilter() const noexcept;
+
+    // Low cuts in float suffer from coefficient rounding and limit cycles, so
+    // double buffers always, and float buffers optionally, run in double.
+    InterleavedChains<float> floatChains;
+    InterleavedChains<double> doubleChains;
+
+    // Audio-thread state: which chains ran last, and at which oversampling factor.
+    bool doubleChainsActive{ false };
+    int activeOversamplingStages{ 0 };
+
+    // Bumped by the APVTS listener whenever any parameter moves.
+    std::atomic<juce::uint32> parametersVersion{ 1 };
+
+    // Design-thread state: what the last published design was made from.
+    // Chain designs are for the oversampled rate, designSampleRate is the host's.
+    juce::uint32 designedParametersVersion{ 0 };
+    double designedSampleRate{ 0.0 };
+    std::atomic<double> designSampleRate{ 0.0 };
+
+    // Design-thread state of the tail length; tailLengthSamples is at the host rate.
+    juce::uint32 tailParametersVersion{ 0 };
+    double tailSampleRate{ 0.0 };
+    std::atomic<double> tailLengthSeconds{ 0.0 };
+    std::atomic<int> tailLengthSamples{ 0 };
+
+    // The linear-phase latency at the rate of the last design or prepareToPlay.
+    std::atomic<int> linearPhaseLatencySamples{ 0 };
+
+    // -120 dBFS: input below it counts as silence, and the tail ends once the output has decayed below it.
+    static constexpr double silenceThreshold = 1.0e-6;
+
+    // Audio-thread state of the silence detection: how long the input has been
+    // silent, and whether the chains have rung out and sit out until it isn't.
+    int silentSamples{ 0 };
+    bool chainsIdle{ false };
+
+    // Finished designs travel from the design thread to the audio thread here.
+    TripleBuffer<ChainCoefficients> coefficientSets;
+
+    // Restored states travel from whichever thread restores them (one at a time,
+    // as hosts do) to the audio thread here.
+    TripleBuffer<RestoredState> restoredStates;
+
+    // Audio-thread state: the parametersVersion of the last design the audio thread made
+    // itself, for a restored state or a MIDI controller; block-rate designs from before it are dropped.
+    juce::uint32 minimumDesignVersion{ 0 };
+
+    // Audio-thread state: set while the smoother glides the block-rate path to a
+    // restored state or fades bands in, and the bands of the last applied design.
+    bool glideActive{ false };
+    juce::uint32 appliedActiveBands{ 0 };
+
+    juce::SharedResourcePointer<CoefficientDesignThread> designThread;
+
+    // Samples between coefficient updates in the smoothed mode, indexed by the
+    // "control rate" parameter; 0 means block-rate updates from the design thread.
+    static constexpr std::array<int, 6> controlIntervals{ 0, 1, 8, 16, 32, 64 };
+    std::atomic<float>* controlRate = nullptr;
+
+    int getControlInterval() const noexcept;
+
+    // The grid band2's dynamics run on when the "control rate" parameter is at block rate.
+    static constexpr int dynamicsControlInterval = 32;
+
+    std::atomic<float>* processingMode = nullptr;
+    std::atomic<float>* oversampling = nullptr;
+    std::atomic<float>* precision = nullptr;
+    std::atomic<float>* band2Dynamics = nullptr;
+
+    // Audio-thread state of the smoothed mode.
+    ChainSmoother chainSmoother;
+    bool smoothingActive{ false };
+    juce::uint32 smoothedParametersVersion{ 0 };
+    int samplesUntilControlTick{ 0 };
+    ChainSettings smoothedSettings;
+
+    // Audio-thread scratch for updateBandsFast(), kept here rather than built on the
+    // stack at every control tick.
+    ChainCoefficients bandCoefficients;
+
+    // Audio-thread state of band2's dynamics; the chains have band2 designed
+    // with appliedDynamicGain added to its static gain.
+    DynamicBand dynamicBand;
+    bool dynamicsActive{ false };
+    float appliedDynamicGain{ 0.f };
+
+    // The linear-phase mode's convolver and FIR kernels. Nothing is allocated for them
+    // until the mode is first selected; then the design thread builds both, sized for
+    // the FIR length of the sample rate, and the convolver crossfades kernels in.
+    TripleBuffer<std::unique_ptr<LinearPhaseFilter>> linearPhaseFilters;
+    TripleBuffer<LinearPhaseFilter::Kernel> linearPhaseKernels;
+
+    // The writer side of both, shared by the design thread and prepareToPlay.
+    juce::CriticalSection linearPhaseLock;
+    int linearPhaseNumChannels{ 0 }, linearPhaseFilterNumChannels{ 0 };
+    double linearPhaseFilterSampleRate{ 0.0 };
+    juce::uint32 linearPhaseParametersVersion{ 0 };
+    double linearPhaseSampleRate{ 0.0 };
+
+    bool linearPhaseActive{ false };
+
+    // Dumped to a file by the design thread when enabled.
+    RealtimeInstrumentation rtInstrumentation;
+
+    // MIDI controllers freqController, gainController and qController on channel n
+    // set band n's freq, gain and q, where it has them.
+    static constexpr int freqController = 16, gainController = 17, qController = 18;
+    static constexpr int numControllers = qController - freqController + 1;
+    std::array<std::array<juce::RangedAudioParameter*, numControllers>, maxBands> controlledParameters{};
+
+    // Bit getControllerIndex() is set for each controller value the audio thread has
+    // stored and the message thread has yet to pass on.
+    std::atomic<juce::uint64> pendingControllerValues{ 0 };
+    static_assert(maxBands * numControllers <= 64, "pendingControllerValues has a bit per controlled parameter");
+
+    static constexpr int minEventSpacing = 16;
+
+    // Helps the audio thread through the channel groups of wide busses while the
+    // "channel threads" parameter is on. The design thread starts the workers when
+    // it is switched on, as many as the prepared bus has groups to share, and stops
+    // them when it is switched off.
+    ChannelWorkerPool workerPool;
+    std::atomic<float>* channelThreads = nullptr;
+    std::atomic<int> numChannelGroups{ 0 };
+
+    // Fed from processBlock, but only while an editor is showing it.
+    SpectrumAnalyzer analyzer;
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SuperFreqAudioProcessor)
 };
@@ -0,0 +1,318 @@
+/*
+  ==============================================================================
+
+    RealtimeInstrumentation.cpp
+
+  ==============================================================================
+*/
+
+#include "RealtimeInstrumentation.h"
+
+#if SUPERFREQ_RT_INSTRUMENTATION && (JUCE_LINUX || JUCE_MAC || JUCE_BSD)
+ #include <dlfcn.h>
+ #include <pthread.h>
+#endif
+
+//==============================================================================
+RealtimeInstrumentation::Snapshot RealtimeInstrumentation::getSnapshot() const noexcept
+{
+    Snapshot snapshot;
+
+    snapshot.numBlocks = numBlocks.load(std::memory_order_relaxed);
+    snapshot.allocations = allocations.load(std::memory_order_relaxed);
+    snapshot.deallocations = deallocations.load(std::memory_order_relaxed);
+    snapshot.mutexLocks = mutexLocks.load(std::memory_order_relaxed);
+    snapshot.designs = designs.load(std::memory_order_relaxed);
+    snapshot.worstLoad = worstLoad.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i < histogram.size(); ++i)
+        snapshot.histogram[i] = histogram[i].load(std::memory_order_relaxed);
+
+    return snapshot;
+}
+
+juce::String RealtimeInstrumentation::createReport() const
+{
+    const auto snapshot = getSnapshot();
+
+    juce::String report;
+
+    report << "SuperFreq real-time report, " << juce::Time::getCurrentTime().toString(true, true) << "\n"
+           << "blocks: " << (juce::int64)snapshot.numBlocks << "\n"
+           << "allocations on the audio thread: " << (juce::int64)snapshot.allocations << "\n"
+           << "deallocations on the audio thread: " << (juce::int64)snapshot.deallocations << "\n"
+           << "mutex locks on the audio thread: " << (countsMutexLocks ? juce::String((juce::int64)snapshot.mutexLocks) : juce::String("not counted on this platform")) << "\n"
+           << "coefficient designs on the audio thread: " << (juce::int64)snapshot.designs << "\n"
+           << "worst block: " << juce::String(snapshot.worstLoad * 100.0, 1) << "% of its deadline\n"
+           << "\n"
+           << "block time / deadline:\n";
+
+    for (int i = 0; i < numHistogramBins; ++i)
+    {
+        const auto count = snapshot.histogram[(size_t)i];
+
+        if (count == 0)
+            continue;
+
+        const auto from = juce::roundToInt(i * histogramBinWidth * 100.0);
+
+        report << (i == numHistogramBins - 1 ? juce::String(from) + "%+"
+                                             : juce::String(from) + "-" + juce::String(juce::roundToInt((i + 1) * histogramBinWidth * 100.0)) + "%").paddedLeft(' ', 10)
+               << "  " << (juce::int64)count << "\n";
+    }
+
+    return report;
+}
+
+// One file per instance in the directory named by SUPERFREQ_RT_REPORT_DIR, or none if it isn't set.
+static juce::File getReportFileFor(const RealtimeInstrumentation* instance)
+{
+    const auto directory = juce::SystemStats::getEnvironmentVariable("SUPERFREQ_RT_REPORT_DIR", {});
+
+    if (! juce::File::isAbsolutePath(directory))
+        return {};
+
+    return juce::File(directory).getChildFile("SuperFreq RT " + juce::String::toHexString((juce::pointer_sized_int)instance) + ".txt");
+}
+
+RealtimeInstrumentation::RealtimeInstrumentation()
+    : reportFile(getReportFileFor(this))
+{
+}
+
+RealtimeInstrumentation::~RealtimeInstrumentation()
+{
+    if (! reportFile.existsAsFile())
+        return;
+
+    reportFile.replaceWithText(createReport());
+    reportFile.moveFileTo(reportFile.getSiblingFile("SuperFreq RT last.txt"));
+}
+
+int RealtimeInstrumentation::useTimeSlice()
+{
+    const auto blocks = numBlocks.load(std::memory_order_relaxed);
+
+    if (reportFile != juce::File() && blocks != numBlocksReported)
+    {
+        numBlocksReported = blocks;
+        getReportFile().replaceWithText(createReport());
+    }
+
+    return 5000;
+}
+
+#if SUPERFREQ_RT_INSTRUMENTATION
+
+//==============================================================================
+// The instance whose processBlock() is running on this thread, if any.
+static thread_local RealtimeInstrumentation* currentInstrumentation = nullptr;
+
+struct RealtimeInstrumentationHooks
+{
+    static void noteAllocation() noexcept
+    {
+        if (auto* instrumentation = currentInstrumentation)
+            RealtimeInstrumentation::incrementShared(instrumentation->allocations);
+    }
+
+    static void noteDeallocation() noexcept
+    {
+        if (auto* instrumentation = currentInstrumentation)
+            RealtimeInstrumentation::incrementShared(instrumentation->deallocations);
+    }
+
+    static void noteMutexLock() noexcept
+    {
+        if (auto* instrumentation = currentInstrumentation)
+            RealtimeInstrumentation::incrementShared(instrumentation->mutexLocks);
+    }
+
+    static void noteDesign() noexcept
+    {
+        if (auto* instrumentation = currentInstrumentation)
+            RealtimeInstrumentation::incrementShared(instrumentation->designs);
+    }
+};
+
+void RealtimeInstrumentation::noteDesign() noexcept
+{
+    RealtimeInstrumentationHooks::noteDesign();
+}
+
+RealtimeInstrumentation* RealtimeInstrumentation::getCurrent() noexcept
+{
+    return currentInstrumentation;
+}
+
+RealtimeInstrumentation::ScopedHelper::ScopedHelper(RealtimeInstrumentation* instance) noexcept
+    : previous(currentInstrumentation)
+{
+    currentInstrumentation = instance;
+}
+
+RealtimeInstrumentation::ScopedHelper::~ScopedHelper() noexcept
+{
+    currentInstrumentation = previous;
+}
+
+RealtimeInstrumentation::ScopedBlock::ScopedBlock(RealtimeInstrumentation& o, int n) noexcept
+    : owner(o), previous(currentInstrumentation), numSamples(n), startTicks(juce::Time::getHighResolutionTicks())
+{
+    currentInstrumentation = &owner;
+}
+
+RealtimeInstrumentation::ScopedBlock::~ScopedBlock() noexcept
+{
+    const auto elapsedTicks = juce::Time::getHighResolutionTicks() - startTicks;
+    currentInstrumentation = previous;
+
+    const auto sampleRate = owner.preparedSampleRate.load(std::memory_order_relaxed);
+
+    if (numSamples <= 0 || sampleRate <= 0.0)
+        return;
+
+    const auto deadline = numSamples / sampleRate;
+    const auto load = juce::Time::highResolutionTicksToSeconds(elapsedTicks) / deadline;
+
+    auto& bin = owner.histogram[(size_t)juce::jlimit(0, numHistogramBins - 1, (int)(load / histogramBinWidth))];
+    increment(bin);
+    increment(owner.numBlocks);
+
+    if (load > owner.worstLoad.load(std::memory_order_relaxed))
+        owner.worstLoad.store(load, std::memory_order_relaxed);
+}
+
+//==============================================================================
+// Replaced for the whole binary. Everything still goes to malloc / free; the hooks
+// only count.
+void* operator new(std::size_t size)
+{
+    RealtimeInstrumentationHooks::noteAllocation();
+
+    if (auto* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    RealtimeInstrumentationHooks::noteAllocation();
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept
+{
+    if (p != nullptr)
+        RealtimeInstrumentationHooks::noteDeallocation();
+
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept                          { operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept               { operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept             { operator delete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept     { operator delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept   { operator delete(p); }
+
+//==============================================================================
+// The over-aligned forms, used for types declared alignas() wider than malloc's.
+static void* allocateAligned(std::size_t size, std::align_val_t alignment) noexcept
+{
+    size = size == 0 ? 1 : size;
+
+   #if JUCE_WINDOWS
+    return _aligned_malloc(size, (std::size_t)alignment);
+   #else
+    void* p = nullptr;
+    return posix_memalign(&p, juce::jmax((std::size_t)alignment, sizeof(void*)), size) == 0 ? p : nullptr;
+   #endif
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    RealtimeInstrumentationHooks::noteAllocation();
+
+    if (auto* p = allocateAligned(size, alignment))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    RealtimeInstrumentationHooks::noteAllocation();
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, alignment, tag);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    if (p != nullptr)
+        RealtimeInstrumentationHooks::noteDeallocation();
+
+   #if JUCE_WINDOWS
+    _aligned_free(p);
+   #else
+    std::free(p);
+   #endif
+}
+
+void operator delete[](void* p, std::align_val_t alignment) noexcept                                { operator delete(p, alignment); }
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept                     { operator delete(p, alignment); }
+void operator delete[](void* p, std::size_t, std::align_val_t alignment) noexcept                   { operator delete(p, alignment); }
+void operator delete(void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept           { operator delete(p, alignment); }
+void operator delete[](void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept         { operator delete(p, alignment); }
+
+//==============================================================================
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+
+// Catches std::mutex and juce::CriticalSection, which both end up here, and
+// forwards to the next definition, the system's.
+using MutexFunction = int (*)(pthread_mutex_t*);
+
+// Looked up on first use, as other static constructors may lock before this file's run.
+static MutexFunction getRealFunction(const char* name) noexcept
+{
+    return (MutexFunction)dlsym(RTLD_NEXT, name);
+}
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    static const auto realMutexLock = getRealFunction("pthread_mutex_lock");
+
+    RealtimeInstrumentationHooks::noteMutexLock();
+    return realMutexLock(mutex);
+}
+
+extern "C" int pthread_mutex_trylock(pthread_mutex_t* mutex)
+{
+    static const auto realMutexTryLock = getRealFunction("pthread_mutex_trylock");
+
+    RealtimeInstrumentationHooks::noteMutexLock();
+    return realMutexTryLock(mutex);
+}
+
+#endif
+
+#endif
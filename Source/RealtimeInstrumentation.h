@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+
+    RealtimeInstrumentation.h
+
+    Opt-in checks that the audio thread stays real-time safe: allocation,
+    mutex and design-call counters, and a histogram of block times.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Off unless the preprocessor definitions set it to 1, as every exporter's
+// Profiling configuration does. It replaces global new / delete and
+// pthread_mutex_lock for the whole binary, so only turn it on in a build you
+// mean to profile, linked with -Bsymbolic on Linux for the plugin.
+#ifndef SUPERFREQ_RT_INSTRUMENTATION
+ #define SUPERFREQ_RT_INSTRUMENTATION 0
+#endif
+
+//==============================================================================
+/**
+    Counts what happens on the audio thread while one processor's processBlock()
+    runs, and how long each block takes relative to its deadline.
+
+    Global operator new / delete are replaced to count heap traffic, and on
+    POSIX platforms pthread_mutex_lock too; only calls made on a thread while
+    one of its ScopedBlocks is alive are attributed to it. An ELF shared object
+    only gets its own definitions when linked with -Bsymbolic, which the Linux
+    exporter sets, and allocations made with malloc directly (e.g. by HeapBlock)
+    are not seen.
+
+    The block timings have a single writer, the audio thread, so they are plain
+    relaxed stores; the event counters are also bumped by threads working for
+    it, and any thread may take a snapshot. With the flag off, the scopes are
+    empty and the hooks aren't compiled.
+
+    No report is written unless the SUPERFREQ_RT_REPORT_DIR environment
+    variable names a directory when the instance is created.
+*/
+class RealtimeInstrumentation  : public juce::TimeSliceClient
+{
+public:
+    // Bins of 5% of the deadline; the last one also takes every overrun past 200%.
+    static constexpr int numHistogramBins = 41;
+    static constexpr double histogramBinWidth = 0.05;
+
+   #if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+    static constexpr bool countsMutexLocks = true;
+   #else
+    static constexpr bool countsMutexLocks = false;
+   #endif
+
+    struct Snapshot
+    {
+        juce::uint64 numBlocks{ 0 };
+        juce::uint64 allocations{ 0 }, deallocations{ 0 }, mutexLocks{ 0 }, designs{ 0 };
+
+        // Block time over the time the block's samples last at the current sample rate.
+        std::array<juce::uint64, numHistogramBins> histogram{};
+        double worstLoad{ 0.0 };
+    };
+
+    //==============================================================================
+    RealtimeInstrumentation();
+
+    /** Moves the report, if there is one, to "SuperFreq RT last.txt" next to it,
+        replacing the one left by the previous instance.
+    */
+    ~RealtimeInstrumentation() override;
+
+    void prepare(double sampleRate) noexcept { preparedSampleRate.store(sampleRate, std::memory_order_relaxed); }
+
+    /** Safe from any thread, though a snapshot taken mid-block may be off by that block. */
+    Snapshot getSnapshot() const noexcept;
+
+    juce::String createReport() const;
+
+    /** Where the background dump goes, one file per instance, or a default File
+        if no report was asked for.
+    */
+    const juce::File& getReportFile() const noexcept { return reportFile; }
+
+    //==============================================================================
+    /** Attributes the calling thread's allocations and locks to this instance, and
+        times the block, for its lifetime. Put one around the body of processBlock().
+    */
+    class ScopedBlock
+    {
+    public:
+       #if SUPERFREQ_RT_INSTRUMENTATION
+        ScopedBlock(RealtimeInstrumentation& owner, int numSamples) noexcept;
+        ~ScopedBlock() noexcept;
+
+    private:
+        RealtimeInstrumentation& owner;
+        RealtimeInstrumentation* previous;
+        int numSamples;
+        juce::int64 startTicks;
+       #else
+        ScopedBlock(RealtimeInstrumentation&, int) noexcept {}
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedBlock)
+    };
+
+    /** Attributes the calling thread's allocations and locks to an instance for its
+        lifetime, without timing anything. For threads that take over part of a
+        processBlock() from the audio thread; a null instance counts nothing.
+    */
+    class ScopedHelper
+    {
+    public:
+       #if SUPERFREQ_RT_INSTRUMENTATION
+        explicit ScopedHelper(RealtimeInstrumentation* instance) noexcept;
+        ~ScopedHelper() noexcept;
+
+    private:
+        RealtimeInstrumentation* previous;
+       #else
+        explicit ScopedHelper(RealtimeInstrumentation*) noexcept {}
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedHelper)
+    };
+
+    /** The instance the calling thread's allocations and locks currently count into, if any. */
+   #if SUPERFREQ_RT_INSTRUMENTATION
+    static RealtimeInstrumentation* getCurrent() noexcept;
+   #else
+    static RealtimeInstrumentation* getCurrent() noexcept { return nullptr; }
+   #endif
+
+    /** Called at the start of the libm-heavy designs, which should never run on the audio thread. */
+   #if SUPERFREQ_RT_INSTRUMENTATION
+    static void noteDesign() noexcept;
+   #else
+    static void noteDesign() noexcept {}
+   #endif
+
+private:
+    // Rewrites the report file, if there is one, every few seconds while blocks are coming in.
+    int useTimeSlice() override;
+
+    //==============================================================================
+    // The hooks in RealtimeInstrumentation.cpp count into whichever instance is
+    // processing on the calling thread, if any.
+    friend struct RealtimeInstrumentationHooks;
+
+    // For the block timings, which only the audio thread writes.
+    static void increment(std::atomic<juce::uint64>& counter) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // For the event counters, which helper threads may bump at the same time.
+    static void incrementShared(std::atomic<juce::uint64>& counter) noexcept
+    {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::atomic<double> preparedSampleRate{ 0.0 };
+
+    std::atomic<juce::uint64> numBlocks{ 0 };
+    std::atomic<juce::uint64> allocations{ 0 }, deallocations{ 0 }, mutexLocks{ 0 }, designs{ 0 };
+
+    std::array<std::atomic<juce::uint64>, numHistogramBins> histogram{};
+    std::atomic<double> worstLoad{ 0.0 };
+
+    const juce::File reportFile;
+    juce::uint64 numBlocksReported{ 0 };
+};
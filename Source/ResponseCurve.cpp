@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.cpp
+
+  ==============================================================================
+*/
+
+#include "ResponseCurve.h"
+
+//==============================================================================
+ResponseCurve::ResponseCurve(SuperFreqAudioProcessor& p, juce::TimeSliceThread& t)
+    : audioProcessor(p), thread(t)
+{
+    for (auto* parameter : audioProcessor.getParameters())
+        if (auto* parameterWithID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter))
+            audioProcessor.apvts.addParameterListener(parameterWithID->paramID, this);
+
+    thread.addTimeSliceClient(this);
+}
+
+ResponseCurve::~ResponseCurve()
+{
+    thread.removeTimeSliceClient(this);
+
+    for (auto* parameter : audioProcessor.getParameters())
+        if (auto* parameterWithID = dynamic_cast<juce::AudioProcessorParameterWithID*> (parameter))
+            audioProcessor.apvts.removeParameterListener(parameterWithID->paramID, this);
+}
+
+void ResponseCurve::setNumPoints(int numPoints) noexcept
+{
+    requestedNumPoints.store(juce::jlimit(0, maxPoints, numPoints));
+}
+
+void ResponseCurve::parameterChanged(const juce::String&, float)
+{
+    // May come from the audio thread during automation, so this only flags the change.
+    parametersVersion.fetch_add(1, std::memory_order_release);
+}
+
+int ResponseCurve::useTimeSlice()
+{
+    const auto version = parametersVersion.load(std::memory_order_acquire);
+    const auto numPoints = requestedNumPoints.load();
+
+    // The chains run, and are designed, at the oversampled rate. Before the host has
+    // prepared the processor, the curve is drawn for a typical rate.
+    const auto designSampleRate = audioProcessor.getDesignSampleRate();
+    const auto sampleRate = designSampleRate > 0.0 ? designSampleRate : 48000.0;
+
+    if (numPoints >= 2 && (version != evaluatedVersion || numPoints != gridNumPoints || sampleRate != gridSampleRate))
+    {
+        evaluatedVersion = version;
+
+        if (numPoints != gridNumPoints || sampleRate != gridSampleRate)
+            updateGrid(numPoints, sampleRate);
+
+        // The SVF and linear-phase modes share the biquads' magnitude response.
+        auto chainSettings = getChainSettings(audioProcessor.getChainParameters());
+        chainSettings.processingMode = ProcessingMode::Mode_Biquad;
+
+        evaluate(makeChainCoefficients(chainSettings, sampleRate), responses.getWriteBuffer());
+        responses.publish();
+    }
+
+    return 1000 / 30;
+}
+
+void ResponseCurve::updateGrid(int numPoints, double sampleRate)
+{
+    gridNumPoints = numPoints;
+    gridSampleRate = sampleRate;
+
+    const auto numVectors = ((size_t)numPoints + SIMDType::size() - 1) / SIMDType::size();
+
+    cosW.assign(numVectors, SIMDType::expand(0.0));
+    cos2W.assign(numVectors, SIMDType::expand(0.0));
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        const auto frequency = minFrequency * std::pow((double)maxFrequency / minFrequency, (double)i / (numPoints - 1));
+        const auto w = juce::MathConstants<double>::twoPi * juce::jmin(frequency, 0.5 * sampleRate) / sampleRate;
+
+        const auto vector = (size_t)i / SIMDType::size();
+        const auto lane = (size_t)i % SIMDType::size();
+
+        cosW[vector].set(lane, std::cos(w));
+        cos2W[vector].set(lane, std::cos(2.0 * w));
+    }
+}
+
+void ResponseCurve::evaluate(const ChainCoefficients& chainCoefficients, Response& response) const
+{
+    // |b0 + b1 z^-1 + b2 z^-2|^2 on the unit circle is
+    // b0^2 + b1^2 + b2^2 + 2(b0 b1 + b1 b2) cos w + 2 b0 b2 cos 2w, and likewise for the poles.
+    struct Terms
+    {
+        double n0, n1, n2, d0, d1, d2;
+    };
+
+    std::array<Terms, maxSections> terms;
+    const auto numSections = chainCoefficients.numSections;
+
+    for (int s = 0; s < numSections; ++s)
+    {
+        const auto& c = chainCoefficients.sections[(size_t)s];
+
+        terms[(size_t)s] = { c.b0 * c.b0 + c.b1 * c.b1 + c.b2 * c.b2, 2.0 * (c.b0 * c.b1 + c.b1 * c.b2), 2.0 * c.b0 * c.b2,
+                             1.0 + c.a1 * c.a1 + c.a2 * c.a2,          2.0 * (c.a1 + c.a1 * c.a2),         2.0 * c.a2 };
+    }
+
+    response.numPoints = gridNumPoints;
+
+    for (size_t vector = 0; vector < cosW.size(); ++vector)
+    {
+        // Numerators and denominators are multiplied up separately, as SIMDRegister can't divide;
+        // in double, even a few cuts deep in their stopband don't underflow.
+        auto numerator = SIMDType::expand(1.0);
+        auto denominator = SIMDType::expand(1.0);
+
+        for (int s = 0; s < numSections; ++s)
+        {
+            const auto& t = terms[(size_t)s];
+
+            numerator = numerator * (cosW[vector] * t.n1 + cos2W[vector] * t.n2 + t.n0);
+            denominator = denominator * (cosW[vector] * t.d1 + cos2W[vector] * t.d2 + t.d0);
+        }
+
+        for (size_t lane = 0; lane < SIMDType::size(); ++lane)
+        {
+            const auto point = vector * SIMDType::size() + lane;
+
+            if (point < (size_t)gridNumPoints)
+                response.decibels[point] = (float)(10.0 * std::log10(juce::jmax(numerator.get(lane) / denominator.get(lane), 1.0e-20)));
+        }
+    }
+}
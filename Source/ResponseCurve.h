@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.h
+
+    The chain's magnitude response for the editor, evaluated off the message
+    thread and only when something it depends on changes.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "TripleBuffer.h"
+
+//==============================================================================
+/**
+    Evaluates the combined magnitude of the bands that are on at log-spaced
+    frequencies on a TimeSliceThread, whenever a parameter, the sample rate or
+    the number of points changes, and hands the result to the editor through a
+    TripleBuffer.
+
+    Each section's squared magnitude is a polynomial in cos w and cos 2w, so with
+    those tabulated once per grid, every section costs a few multiply-adds per
+    point, done a SIMDRegister of points at a time.
+*/
+class ResponseCurve  : private juce::TimeSliceClient,
+                       private juce::AudioProcessorValueTreeState::Listener
+{
+public:
+    static constexpr int maxPoints = 4096;
+    static constexpr float minFrequency = 20.f, maxFrequency = 20000.f;
+
+    /** Point i is at minFrequency * (maxFrequency / minFrequency)^(i / (numPoints - 1)). */
+    struct Response
+    {
+        int numPoints{ 0 };
+        std::array<float, maxPoints> decibels;
+    };
+
+    ResponseCurve(SuperFreqAudioProcessor&, juce::TimeSliceThread&);
+    ~ResponseCurve() override;
+
+    /** Message thread: the number of points to evaluate from now on, typically one per physical pixel. */
+    void setNumPoints(int numPoints) noexcept;
+
+    /** Message thread: acquire() to pick up a newly evaluated response. */
+    TripleBuffer<Response>& getResponses() noexcept { return responses; }
+
+private:
+    int useTimeSlice() override;
+    void parameterChanged(const juce::String&, float) override;
+
+    // Tabulates cos w and cos 2w for the current points and sample rate.
+    void updateGrid(int numPoints, double sampleRate);
+
+    void evaluate(const ChainCoefficients& chainCoefficients, Response& response) const;
+
+    using SIMDType = juce::dsp::SIMDRegister<double>;
+
+    SuperFreqAudioProcessor& audioProcessor;
+    juce::TimeSliceThread& thread;
+
+    std::atomic<juce::uint32> parametersVersion{ 1 };
+    std::atomic<int> requestedNumPoints{ 0 };
+
+    // Worker-thread state: what the last published response was made from.
+    juce::uint32 evaluatedVersion{ 0 };
+    int gridNumPoints{ 0 };
+    double gridSampleRate{ 0.0 };
+    std::vector<SIMDType> cosW, cos2W;
+
+    TripleBuffer<Response> responses;
+
+    JUCE_DECLARE_NON_COPYABLE(ResponseCurve)
+};
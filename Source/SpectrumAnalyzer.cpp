@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+
+//==============================================================================
+// About 0.7 s at 48 kHz, several frames' worth even at 192 kHz.
+static constexpr int fifoOrder = 15;
+
+// Per frame: how much of the previous average each bin keeps, how long peaks
+// hold, and how fast they fall afterwards.
+static constexpr float averagingFactor = 0.7f;
+static constexpr int peakHoldFrames = SpectrumAnalyzer::frameRate;
+static constexpr float peakDecayDecibels = 0.5f;
+
+SpectrumAnalyzer::State::State()
+    : fifos{ AnalyzerFifo(fifoOrder), AnalyzerFifo(fifoOrder) },
+      incoming((size_t)fftSize),
+      fftData((size_t)(2 * fftSize))
+{
+    for (auto& samples : history)
+        samples.assign((size_t)fftSize, 0.f);
+
+    for (auto& trace : current.traces)
+    {
+        trace.average.fill(minDecibels);
+        trace.peak.fill(minDecibels);
+    }
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    // The editor stops the analyzer before it goes, and the editor goes before the processor.
+    jassert(! running.load());
+}
+
+void SpectrumAnalyzer::start(juce::TimeSliceThread& thread)
+{
+    if (state == nullptr)
+        state = std::make_unique<State>();
+
+    // Whatever was left from last time would show up as a burst of stale audio.
+    for (auto& fifo : state->fifos)
+        fifo.skipAll();
+
+    running.store(true, std::memory_order_release);
+    thread.addTimeSliceClient(this);
+}
+
+void SpectrumAnalyzer::stop(juce::TimeSliceThread& thread)
+{
+    thread.removeTimeSliceClient(this);
+    running.store(false, std::memory_order_release);
+}
+
+int SpectrumAnalyzer::useTimeSlice()
+{
+    auto hasNewSamples = false;
+
+    for (int tap = 0; tap < numTaps; ++tap)
+    {
+        auto& fifo = state->fifos[(size_t)tap];
+        auto& history = state->history[(size_t)tap];
+
+        // Only the latest fftSize samples matter, so a backlog is drained and mostly discarded.
+        for (int numRead; (numRead = fifo.pop(state->incoming.data(), fftSize)) > 0;)
+        {
+            std::copy(history.begin() + numRead, history.end(), history.begin());
+            std::copy_n(state->incoming.begin(), numRead, history.end() - numRead);
+            hasNewSamples = true;
+        }
+    }
+
+    if (hasNewSamples)
+    {
+        analyse(Tap::pre);
+        analyse(Tap::post);
+
+        state->current.sampleRate = analysisSampleRate.load(std::memory_order_relaxed);
+
+        state->spectra.getWriteBuffer() = state->current;
+        state->spectra.publish();
+    }
+
+    return 1000 / frameRate;
+}
+
+void SpectrumAnalyzer::analyse(Tap tap)
+{
+    auto& fftData = state->fftData;
+    auto& trace = state->current.traces[(size_t)tap];
+    auto& peakHold = state->peakHold[(size_t)tap];
+
+    std::copy(state->history[(size_t)tap].begin(), state->history[(size_t)tap].end(), fftData.begin());
+    state->window.multiplyWithWindowingTable(fftData.data(), (size_t)fftSize);
+
+    state->fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+    // A full-scale sine reads 0 dB: the Hann window's coherent gain is 0.5 and
+    // the positive bins carry half the amplitude.
+    const auto scale = 4.f / (float)fftSize;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        const auto decibels = juce::Decibels::gainToDecibels(fftData[(size_t)bin] * scale, minDecibels);
+
+        auto& average = trace.average[(size_t)bin];
+        average = averagingFactor * average + (1.f - averagingFactor) * decibels;
+
+        auto& peak = trace.peak[(size_t)bin];
+        auto& hold = peakHold[(size_t)bin];
+
+        if (average >= peak)
+        {
+            peak = average;
+            hold = peakHoldFrames;
+        }
+        else if (hold > 0)
+        {
+            --hold;
+        }
+        else
+        {
+            peak = juce::jmax(average, peak - peakDecayDecibels);
+        }
+    }
+}
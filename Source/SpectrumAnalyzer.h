@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+
+    Pre / post spectrum analysis for the editor. The audio thread only copies
+    samples into wait-free FIFOs; the FFTs run on a shared background thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "TripleBuffer.h"
+
+//==============================================================================
+/**
+    A wait-free single-producer, single-consumer FIFO of mono samples.
+
+    push() downmixes the channels of a block straight into the ring. If the
+    consumer has fallen behind, whatever doesn't fit is dropped rather than
+    overwriting unread samples, so neither side ever waits for the other.
+*/
+class AnalyzerFifo
+{
+public:
+    explicit AnalyzerFifo(int sizeOrder) : buffer((size_t)1 << sizeOrder), mask((juce::uint32)buffer.size() - 1) {}
+
+    /** Producer side. Allocation-free. */
+    template <typename SampleType>
+    void push(const SampleType* const* channels, int numChannels, int numSamples) noexcept
+    {
+        if (numChannels <= 0)
+            return;
+
+        const auto write = writePosition.load(std::memory_order_relaxed);
+        const auto read = readPosition.load(std::memory_order_acquire);
+
+        const auto numFree = (juce::uint32)buffer.size() - (write - read);
+        const auto numToWrite = juce::jmin((juce::uint32)numSamples, numFree);
+        const auto gain = 1.f / (float)numChannels;
+
+        for (juce::uint32 i = 0; i < numToWrite; ++i)
+        {
+            auto sum = 0.f;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                sum += (float)channels[channel][i];
+
+            buffer[(size_t)((write + i) & mask)] = sum * gain;
+        }
+
+        writePosition.store(write + numToWrite, std::memory_order_release);
+    }
+
+    /** Consumer side: copies out up to maxSamples of the oldest samples and returns how many. */
+    int pop(float* destination, int maxSamples) noexcept
+    {
+        const auto read = readPosition.load(std::memory_order_relaxed);
+        const auto write = writePosition.load(std::memory_order_acquire);
+
+        const auto numToRead = juce::jmin((juce::uint32)maxSamples, write - read);
+
+        for (juce::uint32 i = 0; i < numToRead; ++i)
+            destination[i] = buffer[(size_t)((read + i) & mask)];
+
+        readPosition.store(read + numToRead, std::memory_order_release);
+        return (int)numToRead;
+    }
+
+    /** Consumer side: drops everything written so far. */
+    void skipAll() noexcept
+    {
+        readPosition.store(writePosition.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    std::vector<float> buffer;
+    const juce::uint32 mask;
+
+    // Free-running counts; their difference is the fill level, even across wrap-around.
+    std::atomic<juce::uint32> writePosition{ 0 }, readPosition{ 0 };
+};
+
+//==============================================================================
+/** A low-priority thread, shared by every open editor, that runs the analyzers. */
+struct AnalyzerThread  : public juce::TimeSliceThread
+{
+    AnalyzerThread() : juce::TimeSliceThread("SuperFreq Analyzer")
+    {
+        startThread(juce::Thread::Priority::low);
+    }
+
+    ~AnalyzerThread() override
+    {
+        stopThread(2000);
+    }
+};
+
+//==============================================================================
+/**
+    Averaged, peak-held magnitude spectra of the processor's input and output.
+
+    Nothing is allocated and the audio thread does nothing until an editor first
+    start()s the analyzer, so closed instances cost a relaxed load per block.
+    While running, the analysis thread picks up whatever the FIFOs hold at most
+    frameRate times a second, windows the most recent fftSize samples of each
+    tap and publishes the result to the editor through a TripleBuffer.
+*/
+class SpectrumAnalyzer  : private juce::TimeSliceClient
+{
+public:
+    static constexpr int fftOrder = 12;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numBins = fftSize / 2 + 1;
+    static constexpr int frameRate = 30;
+
+    static constexpr float minDecibels = -96.f;
+
+    enum Tap
+    {
+        pre,
+        post,
+        numTaps
+    };
+
+    struct Trace
+    {
+        std::array<float, numBins> average, peak;
+    };
+
+    struct Spectrum
+    {
+        double sampleRate{ 0.0 };
+        std::array<Trace, numTaps> traces;
+    };
+
+    ~SpectrumAnalyzer() override;
+
+    void prepare(double sampleRate) noexcept { analysisSampleRate.store(sampleRate, std::memory_order_relaxed); }
+
+    /** Audio thread: adds the block's mono sum to the tap's FIFO, if the analyzer is running. */
+    template <typename SampleType>
+    void push(Tap tap, const juce::AudioBuffer<SampleType>& buffer, int numChannels) noexcept
+    {
+        if (! running.load(std::memory_order_acquire))
+            return;
+
+        state->fifos[(size_t)tap].push(buffer.getArrayOfReadPointers(), juce::jmin(numChannels, buffer.getNumChannels()), buffer.getNumSamples());
+    }
+
+    //==============================================================================
+    /** Message thread: allocates on first use and starts analysing on the given thread. */
+    void start(juce::TimeSliceThread& thread);
+
+    /** Message thread: stops analysing. Returns once the thread has let go of it. */
+    void stop(juce::TimeSliceThread& thread);
+
+    /** Editor side of the hand-over; only valid between start() and stop(). */
+    TripleBuffer<Spectrum>& getSpectra() noexcept { return state->spectra; }
+
+private:
+    int useTimeSlice() override;
+
+    // Everything the analyzer needs once it runs, allocated the first time it does.
+    struct State
+    {
+        State();
+
+        std::array<AnalyzerFifo, numTaps> fifos;
+
+        juce::dsp::FFT fft{ fftOrder };
+        juce::dsp::WindowingFunction<float> window{ (size_t)fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+
+        // The latest fftSize samples of each tap, oldest first.
+        std::array<std::vector<float>, numTaps> history;
+        std::vector<float> incoming, fftData;
+
+        // Frames left before each bin's peak starts to fall.
+        std::array<std::array<int, numBins>, numTaps> peakHold{};
+
+        Spectrum current;
+        TripleBuffer<Spectrum> spectra;
+    };
+
+    void analyse(Tap tap);
+
+    std::unique_ptr<State> state;
+    std::atomic<bool> running{ false };
+    std::atomic<double> analysisSampleRate{ 0.0 };
+};
@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    SvfSection.h
+
+    Topology-preserving (TPT) state-variable filter sections, for use as the
+    Section of a SectionCascade.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CascadeFilter.h"
+
+//==============================================================================
+/**
+    Coefficients of one trapezoidal SVF section (Zavalishin / Simper form).
+
+    g = tan(pi fc / fs) and k = 1 / Q set the shared core; the output is
+    m0 * input + m1 * band + m2 * low. Unlike a biquad, moving the frequency only
+    needs g and a1..a3, and moving the gain only touches k and m1, so updates
+    cost one division and a few multiplies once g is known.
+
+    The default is a pass-through.
+*/
+template <typename NumericType>
+struct SvfCoefficients
+{
+    NumericType a1{ 1 }, a2{ 0 }, a3{ 0 };
+    NumericType m0{ 1 }, m1{ 0 }, m2{ 0 };
+
+    static SvfCoefficients makeHighPass(NumericType g, NumericType k) noexcept { return make(g, k, 1, -k, -1); }
+
+    static SvfCoefficients makeLowPass(NumericType g, NumericType k) noexcept { return make(g, k, 0, 0, 1); }
+
+    /** A bell of linear amplitude a * a, i.e. a = 10^(gain dB / 40). */
+    static SvfCoefficients makePeak(NumericType g, NumericType invQ, NumericType a) noexcept
+    {
+        const auto k = invQ / a;
+        return make(g, k, 1, k * (a * a - 1), 0);
+    }
+
+    /** Shelves of linear amplitude a * a, like the bell's. g is that of the
+        shelf's midpoint frequency; the shelf moves it by sqrt(a) itself.
+    */
+    static SvfCoefficients makeLowShelf(NumericType g, NumericType invQ, NumericType a) noexcept
+    {
+        return make(g / std::sqrt(a), invQ, 1, invQ * (a - 1), a * a - 1);
+    }
+
+    static SvfCoefficients makeHighShelf(NumericType g, NumericType invQ, NumericType a) noexcept
+    {
+        return make(g * std::sqrt(a), invQ, a * a, invQ * (1 - a) * a, 1 - a * a);
+    }
+
+    /** The same section at another precision. */
+    template <typename OtherType>
+    static SvfCoefficients from(const SvfCoefficients<OtherType>& c) noexcept
+    {
+        return { (NumericType)c.a1, (NumericType)c.a2, (NumericType)c.a3, (NumericType)c.m0, (NumericType)c.m1, (NumericType)c.m2 };
+    }
+
+private:
+    static SvfCoefficients make(NumericType g, NumericType k, NumericType m0, NumericType m1, NumericType m2) noexcept
+    {
+        const auto a1 = 1 / (1 + g * (g + k));
+        const auto a2 = g * a1;
+
+        return { a1, a2, g * a2, m0, m1, m2 };
+    }
+};
+
+/** A trapezoidal state-variable filter section. It stays well behaved under fast
+    modulation and keeps its precision at low frequencies in float.
+*/
+template <typename NumericType>
+struct SvfSection
+{
+    using Coefficients = SvfCoefficients<NumericType>;
+
+    template <typename SampleType>
+    struct State
+    {
+        SampleType ic1 = SampleType(0), ic2 = SampleType(0);
+    };
+
+    template <typename SampleType>
+    static SampleType process(SampleType x, const Coefficients& c, State<SampleType>& z) noexcept
+    {
+        const auto v3 = x - z.ic2;
+        const auto v1 = (z.ic1 * c.a1) + (v3 * c.a2);
+        const auto v2 = z.ic2 + (z.ic1 * c.a2) + (v3 * c.a3);
+
+        z.ic1 = (v1 * (NumericType)2) - z.ic1;
+        z.ic2 = (v2 * (NumericType)2) - z.ic2;
+
+        return (x * c.m0) + (v1 * c.m1) + (v2 * c.m2);
+    }
+};
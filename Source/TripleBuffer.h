@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+
+    Lock-free hand-over of the latest value from one writer thread to one
+    reader thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Three preallocated slots: one owned by the writer, one owned by the reader
+    and one waiting in between.
+
+    The writer fills getWriteBuffer() and publish()es it, which swaps it with the
+    waiting slot. The reader calls acquire() to swap its slot with the waiting one
+    if something new has been published, which retires the slot it was reading
+    back to the writer. Neither side ever blocks or allocates, and a reader that
+    falls behind simply skips to the most recent value.
+*/
+template <typename Type>
+class TripleBuffer
+{
+public:
+    //==============================================================================
+    /** Writer side: the slot to fill before calling publish(). */
+    Type& getWriteBuffer() noexcept { return buffers[(size_t)writeIndex]; }
+
+    /** Writer side: makes the write buffer the latest value. */
+    void publish() noexcept
+    {
+        const auto previous = waiting.exchange(writeIndex | freshFlag, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    //==============================================================================
+    /** Reader side: takes the most recently published value, if there is a new one. */
+    bool acquire() noexcept
+    {
+        if ((waiting.load(std::memory_order_relaxed) & freshFlag) == 0)
+            return false;
+
+        const auto previous = waiting.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        return true;
+    }
+
+    /** Reader side: the value taken by the last successful acquire(). */
+    const Type& getReadBuffer() const noexcept { return buffers[(size_t)readIndex]; }
+
+private:
+    static constexpr int indexMask = 3, freshFlag = 4;
+
+    std::array<Type, 3> buffers{};
+    int writeIndex{ 0 }, readIndex{ 1 };
+    std::atomic<int> waiting{ 2 };
+
+    static_assert(std::atomic<int>::is_always_lock_free, "The hand-over must not fall back to a lock");
+};